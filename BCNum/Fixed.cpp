@@ -32,7 +32,9 @@ SUCH DAMAGE.
    rules for result precision.
 */
 
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <string>
 #include "Fixed.hpp"
 
@@ -40,9 +42,7 @@ namespace BigInt
  {
 
 
-   unsigned long Fixed::defPrec = 0;
-
-   Fixed_Round_Mode Fixed::mode = ROUND_TIES_EVEN;
+   thread_local Fixed_Context Fixed::context;
 
 
    Fixed::Fixed (const std::string & from)
@@ -129,19 +129,14 @@ namespace BigInt
 
    int Fixed::compare (const Fixed & to) const
     {
-      Fixed temp;
-
+         // Line up the scales within the comparison, rather than making a rescaled copy.
       if (Digits > to.Digits)
        {
-         temp = to;
-         temp.changePrecision(Digits);
-         return Data.compare(temp.Data);
+         return Data.compareScaled(to.Data, Digits - to.Digits);
        }
       else if (Digits < to.Digits)
        {
-         temp = *this;
-         temp.changePrecision(to.Digits);
-         return temp.Data.compare(to.Data);
+         return -to.Data.compareScaled(Data, to.Digits - Digits);
        }
 
       return Data.compare(to.Data);
@@ -177,13 +172,13 @@ namespace BigInt
        {
          temp = rhs;
          temp.changePrecision(lhs.Digits);
-         temp.Data = lhs.Data + temp.Data;
+         temp.Data += lhs.Data;
        }
       else if (lhs.Digits < rhs.Digits)
        {
          temp = lhs;
          temp.changePrecision(rhs.Digits);
-         temp.Data = temp.Data + rhs.Data;
+         temp.Data += rhs.Data;
        }
       else
        {
@@ -194,6 +189,75 @@ namespace BigInt
       return temp;
     }
 
+   Fixed_Accumulator & Fixed_Accumulator::operator += (const Fixed & addend)
+    {
+         // Once the sum isn't a number, do what operator + does with what comes next.
+      if (true == special)
+       {
+         if (true == Special.nan)
+          {
+            return *this;
+          }
+         if (true == addend.nan)
+          {
+            Special = addend;
+          }
+         else if (true == addend.infinity)
+          {
+            Special = Fixed(false, true);
+          }
+         return *this;
+       }
+      if ((true == addend.nan) || (true == addend.infinity))
+       {
+         Special = addend;
+         special = true;
+         return *this;
+       }
+
+         // A larger scale raises the sum once; an addend of a smaller scale is raised as it is added.
+      if (addend.Digits > Digits)
+       {
+         Data.scale(addend.Digits - Digits);
+         Digits = addend.Digits;
+       }
+      Data.add(addend.Data, Digits - addend.Digits);
+
+      return *this;
+    }
+
+   void Fixed_Accumulator::addProduct (const Fixed & lhs, const Fixed & rhs, const Fixed_Context & with)
+    {
+      const unsigned long digits = lhs.Digits + rhs.Digits;
+
+         // Only an exact product can go straight into the sum: one that multiply would round, or that isn't a number, is made first.
+      if ((true == special) || (true == lhs.nan) || (true == lhs.infinity) || (true == rhs.nan) || (true == rhs.infinity) ||
+          (digits > std::max(std::max(lhs.Digits, rhs.Digits), with.precision)))
+       {
+         *this += Fixed::multiply(lhs, rhs, with);
+         return;
+       }
+
+      if (digits > Digits)
+       {
+         Data.scale(digits - Digits);
+         Digits = digits;
+       }
+      Data.addProduct(lhs.Data, rhs.Data, Digits - digits);
+    }
+
+   Fixed Fixed_Accumulator::get (void) const
+    {
+      if (true == special)
+       {
+         return Special;
+       }
+
+      Fixed result (Digits);
+      result.Data = Data.get();
+      return result;
+    }
+
    Fixed operator - (const Fixed & lhs, const Fixed & rhs)
     {
       if (true == lhs.nan)
@@ -223,13 +287,13 @@ namespace BigInt
        {
          temp = rhs;
          temp.changePrecision(lhs.Digits);
-         temp.Data = lhs.Data - temp.Data;
+         temp.Data.negate() += lhs.Data;
        }
       else if (lhs.Digits < rhs.Digits)
        {
          temp = lhs;
          temp.changePrecision(rhs.Digits);
-         temp.Data = temp.Data - rhs.Data;
+         temp.Data -= rhs.Data;
        }
       else
        {
@@ -241,6 +305,11 @@ namespace BigInt
     }
 
    Fixed operator * (const Fixed & lhs, const Fixed & rhs)
+    {
+      return Fixed::multiply(lhs, rhs, Fixed::getContext());
+    }
+
+   Fixed Fixed::multiply (const Fixed & lhs, const Fixed & rhs, const Fixed_Context & with)
     {
       if (true == lhs.nan)
        {
@@ -274,12 +343,22 @@ namespace BigInt
 
       // This strange rule here is how the library gets its name:
       // the bc rules for result scale.
-      temp.changePrecision(std::min(temp.Digits, std::max(std::max(lhs.Digits, rhs.Digits), Fixed::getDefaultPrecision())));
+      temp.changePrecision(std::min(temp.Digits, std::max(std::max(lhs.Digits, rhs.Digits), with.precision)), with.mode);
 
       return temp;
     }
 
    Fixed operator / (const Fixed & lhs, const Fixed & rhs)
+    {
+      return Fixed::divide(lhs, rhs, Fixed::getContext());
+    }
+
+   Fixed Fixed::divide (const Fixed & lhs, const Fixed & rhs, const Fixed_Context & with)
+    {
+      return divide(lhs, rhs, with, nullptr);
+    }
+
+   Fixed Fixed::divide (const Fixed & lhs, const Fixed & rhs, const Fixed_Context & with, Integer_Divisor * divisor)
     {
       if (true == lhs.nan)
        {
@@ -320,35 +399,158 @@ namespace BigInt
          // desired scale = q - r + x
          // x = scale + r - q
          // x > 0, scale q by x ; x < 0, scale r by -x
-      if (Fixed::getDefaultPrecision() + r.Digits >= q.Digits)
+      if (with.precision + r.Digits >= q.Digits)
        {
-         q.Data = q.Data * pow10(Fixed::getDefaultPrecision() + r.Digits - q.Digits);
+         q.Data *= pow10(with.precision + r.Digits - q.Digits);
        }
       else
        {
-         r.Data = r.Data * pow10(q.Digits - Fixed::getDefaultPrecision() - r.Digits);
+         r.Data *= pow10(q.Digits - with.precision - r.Digits);
+         divisor = nullptr; // It isn't the same divisor anymore.
        }
-      q.Digits = Fixed::getDefaultPrecision();
+      q.Digits = with.precision;
 
       d = r.Data;
       d.abs();
 
-      quotrem(q.Data, r.Data, q.Data, r.Data);
+      if (nullptr != divisor)
+       {
+         divisor->quotrem(q.Data, q.Data, r.Data);
+       }
+      else
+       {
+         quotrem(q.Data, r.Data, q.Data, r.Data);
+       }
 
-      r.Data = r.Data * Integer(2U);
+      r.Data *= Integer(2U);
 
       if (Fixed::decideRound(s, q.Data.isEven(), d.compare(r.Data.abs()),
-                             r.Data.isZero(), q.Data.is0mod5()))
+                             r.Data.isZero(), q.Data.is0mod5(), with.mode))
        {
-         if (s) q.Data = q.Data - Integer(1U);
-         else q.Data = q.Data + Integer(1U);
+         if (s) q.Data.decrement();
+         else q.Data.increment();
        }
 
       return q;
     }
 
 
+   bool Fixed_Divisor::matches (const Fixed & divisor) const
+    {
+      return (divisor.infinity == Divisor.infinity) && (divisor.nan == Divisor.nan) &&
+         (divisor.Digits == Divisor.Digits) && (0 == divisor.Data.compare(Divisor.Data));
+    }
+
+   Fixed Fixed_Divisor::divide (const Fixed & lhs, const Fixed_Context & with)
+    {
+      return Fixed::divide(lhs, Divisor, with, &Data);
+    }
+
+
+   Fixed Fixed::multiplyAdd (const Fixed & lhs, const Fixed & rhs, const Fixed & addend, const Fixed_Context & with)
+    {
+      const unsigned long digits = lhs.Digits + rhs.Digits;
+
+         // As in Fixed_Accumulator::addProduct: only an exact product can go straight into the sum.
+      if ((true == lhs.nan) || (true == lhs.infinity) || (true == rhs.nan) || (true == rhs.infinity) ||
+          (true == addend.nan) || (true == addend.infinity) ||
+          (digits > std::max(std::max(lhs.Digits, rhs.Digits), with.precision)))
+       {
+         Fixed result = multiply(lhs, rhs, with);
+         result += addend; // The product isn't shared with anything yet, so this adds into it in place.
+         return result;
+       }
+
+      Fixed result = addend;
+      if (digits > result.Digits)
+       {
+         result.changePrecision(digits);
+       }
+      if (result.Digits > digits)
+       {
+         result.Data.addProduct(lhs.Data * pow10(result.Digits - digits), rhs.Data);
+       }
+      else
+       {
+         result.Data.addProduct(lhs.Data, rhs.Data);
+       }
+      return result;
+    }
+
+   Fixed & Fixed::operator += (const Fixed & rhs)
+    {
+      if ((true == nan) || (true == infinity) || (true == rhs.nan) || (true == rhs.infinity))
+       {
+         return *this = *this + rhs;
+       }
+
+      if (Digits < rhs.Digits)
+       {
+         changePrecision(rhs.Digits);
+       }
+      if (Digits > rhs.Digits)
+       {
+         Data.addProduct(rhs.Data, pow10(Digits - rhs.Digits));
+       }
+      else
+       {
+         Data += rhs.Data;
+       }
+      return *this;
+    }
+
+   Fixed & Fixed::operator -= (const Fixed & rhs)
+    {
+      if ((true == nan) || (true == infinity) || (true == rhs.nan) || (true == rhs.infinity))
+       {
+         return *this = *this - rhs;
+       }
+
+      if (Digits < rhs.Digits)
+       {
+         changePrecision(rhs.Digits);
+       }
+      if (Digits > rhs.Digits)
+       {
+         Data.addProduct(-rhs.Data, pow10(Digits - rhs.Digits));
+       }
+      else
+       {
+         Data -= rhs.Data;
+       }
+      return *this;
+    }
+
+   Fixed & Fixed::operator *= (const Fixed & rhs)
+    {
+      if ((true == nan) || (true == infinity) || (true == rhs.nan) || (true == rhs.infinity))
+       {
+         return *this = multiply(*this, rhs, context);
+       }
+
+      const unsigned long lhsDigits = Digits, rhsDigits = rhs.Digits;
+
+      Data *= rhs.Data;
+      Digits = lhsDigits + rhsDigits;
+
+         // The same bc rule for result scale as multiply.
+      changePrecision(std::min(Digits, std::max(std::max(lhsDigits, rhsDigits), context.precision)), context.mode);
+
+      return *this;
+    }
+
+   Fixed & Fixed::operator /= (const Fixed & rhs)
+    {
+      return *this = divide(*this, rhs, context);
+    }
+
+
    void Fixed::changePrecision (unsigned long newPrec)
+    {
+      changePrecision(newPrec, context.mode);
+    }
+
+   void Fixed::changePrecision (unsigned long newPrec, Fixed_Round_Mode withMode)
     {
       Integer scale, rem;
       bool s = Data.isSigned();
@@ -356,21 +558,20 @@ namespace BigInt
       if (newPrec == Digits) return;
       if (newPrec > Digits)
        {
-         scale = pow10(newPrec - Digits);
-         Data = Data * scale;
+         Data *= pow10(newPrec - Digits);
        }
       else
        {
          scale = pow10(Digits - newPrec);
          quotrem(Data, scale, Data, rem);
 
-         rem = rem * Integer(2U);
+         rem *= Integer(2U);
 
          if (decideRound(s, Data.isEven(), scale.compare(rem.abs()),
-                         rem.isZero(), Data.is0mod5()))
+                         rem.isZero(), Data.is0mod5(), withMode))
           {
-            if (s) Data = Data - Integer(1U);
-            else Data = Data + Integer(1U);
+            if (s) Data.decrement();
+            else Data.increment();
           }
        }
       Digits = newPrec;
@@ -379,7 +580,6 @@ namespace BigInt
 
    std::string Fixed::toString (void) const
     {
-      std::string result, sign;
       if (true == infinity)
        {
          return "Infinity";
@@ -388,42 +588,87 @@ namespace BigInt
        {
          return "Not a Result";
        }
-      result = Data.toString();
-      if (Digits == 0) return result;
-      if ('-' == result[0])
+      if (Digits == 0) return Data.toString();
+
+         // Make the buffer once, big enough for either "-digits.fraction" or "-0.zerosdigits", and write into it.
+      const size_t sign = Data.isSigned() ? 1U : 0U;
+      std::string result (sign + std::max<size_t>(Data.maxDigits() + 1U, Digits + 2U) + 1U, '-');
+      char* digits = &result[sign];
+      const size_t length = Data.toDigits(digits);
+
+      if (length > Digits)
+       {
+         const size_t whole = length - Digits;
+         std::memmove(digits + whole + 1U, digits + whole, Digits);
+         digits[whole] = '.';
+         result.resize(sign + length + 1U);
+       }
+      else
+       {
+         const size_t leading = Digits + 2U - length; // "0." and the zeros before the digits
+         std::memmove(digits + leading, digits, length);
+         std::memset(digits, '0', leading);
+         digits[1] = '.';
+         result.resize(sign + Digits + 2U);
+       }
+      return result;
+    }
+
+
+   std::string Fixed::leadingString (size_t length) const
+    {
+      if ((true == infinity) || (true == nan))
+       {
+         return toString();
+       }
+
+         // One more than asked for, so that the caller can tell that there is more.
+      size_t total;
+      const std::string digits = Data.leadingDigits(length + 1U, total);
+      if ((digits.length() == total) && (total + Digits <= length + 1U))
        {
-         sign = "-";
-         result = result.substr(1);
+         return toString(); // It was all converted anyway, and it is short.
        }
-      if (result.length() <= Digits)
+         // Otherwise, the digits may be few, but the zeros after the point many: only write what is shown.
+
+      std::string result;
+      result.reserve(length + 3U);
+      if (true == Data.isSigned()) result += '-';
+      if (total > Digits)
        {
-         while (result.length() < Digits)
+         const size_t whole = total - Digits;
+         if (whole < digits.length())
           {
-            result = '0' + result;
+            result.append(digits, 0U, whole);
+            result += '.';
+            result.append(digits, whole, std::string::npos);
+          }
+         else
+          {
+            result += digits;
           }
-         result = sign + '0' + '.' + result;
        }
       else
        {
-         result = sign + result.substr(0, result.length() - Digits) + '.' +
-            result.substr(result.length() - Digits, Digits);
+         result += "0.";
+         result.append(std::min<size_t>(Digits - total, length + 1U), '0');
+         result += digits;
        }
+      if (result.length() > length + 1U) result.resize(length + 1U);
       return result;
     }
 
 
    void Fixed::fromString (const char* src)
     {
-      const char* iter = src, *base;
-      std::string conv;
-
-      conv.reserve(2048);
+      const char* iter = src, *whole, *base;
 
       infinity = false;
       nan = false;
 
          // Fast path for an integer.
       if (*iter == '-') ++iter;
+      whole = iter;
       if ((*iter != '.') && (*iter != ','))
        {
          while ((*iter >= '0') && (*iter <= '9')) ++iter;
@@ -445,7 +690,6 @@ namespace BigInt
          while ((*iter >= '0') && (*iter <= '9')) { ++iter; ++Digits; }
        }
 
-      Integer extraScale (1U);
          // Note: any sane value of exponent here will be well within
          // the capabilities of the underlying representation.
       long exponent = 0;
@@ -459,6 +703,11 @@ namespace BigInt
        {
          exponent = std::strtol(base + 1, nullptr, 10);
        }
+
+         // Read the number straight from the source, skipping over the separator.
+      Data.fromDigits(whole, base - whole, base + 1, iter - base - 1);
+      if (whole != src) Data.negate();
+
          // Was an exponent given?
       if (exponent < 0)
        {
@@ -466,22 +715,8 @@ namespace BigInt
        }
       else if (exponent > 0)
        {
-         extraScale = pow10(static_cast<unsigned long>(exponent));
+         Data *= pow10(static_cast<unsigned long>(exponent));
        }
-
-         // Now, recompose just the number without the separator.
-      if (base != src)
-       {
-         conv.append(src, base - src);
-       }
-      ++base;
-      if (base != iter)
-       {
-         conv.append(base, iter - base);
-       }
-
-      Data.fromString(conv);
-      Data = Data * extraScale;
     }
 
 
@@ -503,24 +738,79 @@ namespace BigInt
          scale = pow10(temp.Digits); // All the way to zero.
          quotrem(temp.Data, scale, temp.Data, rem);
 
-         rem = rem * Integer(2U);
+         rem *= Integer(2U);
 
          if (decideRound(s, temp.Data.isEven(), scale.compare(rem.abs()),
                          rem.isZero(), temp.Data.is0mod5(), withMode))
           {
-            if (s) temp.Data = temp.Data - Integer(1U);
-            else temp.Data = temp.Data + Integer(1U);
+            if (s) temp.Data.decrement();
+            else temp.Data.increment();
           }
 
-         temp.Data = temp.Data * scale;
+         temp.Data *= scale;
        }
       return temp;
     }
 
 
+   Fixed Fixed::squareRoot (const Fixed & from, const Fixed_Context & with)
+    {
+      if (true == from.nan)
+       {
+         return from;
+       }
+      if (true == from.isSigned())
+       {
+         return Fixed(false, true);
+       }
+      if (true == from.infinity)
+       {
+         return from;
+       }
+
+      Fixed result (with.precision);
+      Integer radicand, rem;
+      int comp;
+      bool zero;
+
+         // The root of Data * 10^-Digits, scaled by 10^precision, is the root of Data * 10^(2 * precision - Digits).
+      if (2U * with.precision >= from.Digits)
+       {
+         radicand = from.Data * pow10(2U * with.precision - from.Digits);
+         sqrtrem(radicand, result.Data, rem);
+
+            // The root is past halfway to the next integer when rem > root + 1/4: never exactly halfway.
+         comp = (rem.compare(result.Data) <= 0) ? 1 : -1;
+         zero = rem.isZero();
+       }
+      else
+       {
+            // The radicand has digits below the root's last: the floor of the root of the floor is the floor of the root.
+         const unsigned long extra = from.Digits - 2U * with.precision;
+         Integer dropped;
+         quotrem(from.Data, pow10(extra), radicand, dropped);
+         sqrtrem(radicand, result.Data, rem);
+
+            // Compare the root with the root plus a half: that is, 4 * Data with (2 * root + 1)^2 * 10^extra.
+         Integer half = result.Data * Integer(2U);
+         half.increment();
+         half = half * half;
+         comp = -(from.Data * Integer(4U)).compareScaled(half, extra);
+         zero = rem.isZero() && dropped.isZero();
+       }
+
+      if (Fixed::decideRound(false, result.Data.isEven(), comp, zero, result.Data.is0mod5(), with.mode))
+       {
+         result.Data.increment();
+       }
+
+      return result;
+    }
+
+
    bool Fixed::decideRound (bool sign, bool even, int comp, bool zero, bool zmf)
     {
-      return decideRound(sign, even, comp, zero, zmf, mode);
+      return decideRound(sign, even, comp, zero, zmf, context.mode);
     }
 
    bool Fixed::decideRound (bool sign, bool even, int comp, bool zero, bool zmf, Fixed_Round_Mode thisMode)
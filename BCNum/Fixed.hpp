@@ -32,6 +32,8 @@ SUCH DAMAGE.
 
 #include "Integer.hpp"
 
+#include <utility>
+
 namespace BigInt
  {
 
@@ -48,21 +50,43 @@ namespace BigInt
       ROUND_DOUBLE
     };
 
+      // The scale and rounding mode that arithmetic is done with.
+      // Each thread has its own, so that one computation can't change the precision of another.
+   class Fixed_Context final
+    {
+
+      public:
+         unsigned long precision;
+         Fixed_Round_Mode mode;
+
+         constexpr explicit Fixed_Context (unsigned long precision = 0U, Fixed_Round_Mode mode = ROUND_TIES_EVEN) :
+            precision(precision), mode(mode) { }
+
+    }; /* class Fixed_Context */
+
+   inline bool operator == (const Fixed_Context & lhs, const Fixed_Context & rhs)
+      { return (lhs.precision == rhs.precision) && (lhs.mode == rhs.mode); }
+   inline bool operator != (const Fixed_Context & lhs, const Fixed_Context & rhs)
+      { return !(lhs == rhs); }
+
    class Fixed final
     {
 
       private:
-         static unsigned long defPrec;
-         static Fixed_Round_Mode mode;
+         static thread_local Fixed_Context context;
 
       public:
-         static unsigned long getDefaultPrecision (void) { return defPrec; }
+         static const Fixed_Context & getContext (void) { return context; }
+         static Fixed_Context setContext (const Fixed_Context & newContext) // Returns the old context.
+          { Fixed_Context old = context; context = newContext; return old; }
+
+         static unsigned long getDefaultPrecision (void) { return context.precision; }
          static unsigned long setDefaultPrecision (unsigned long newPrecision)
-          { return (defPrec = newPrecision); }
+          { return (context.precision = newPrecision); }
 
-         static Fixed_Round_Mode getRoundMode (void) { return mode; }
+         static Fixed_Round_Mode getRoundMode (void) { return context.mode; }
          static Fixed_Round_Mode setRoundMode (Fixed_Round_Mode newMode)
-          { return (mode = newMode); }
+          { return (context.mode = newMode); }
 
          static bool decideRound (bool, bool, int, bool, bool); // Public so it can be tested.
          static bool decideRound (bool, bool, int, bool, bool, Fixed_Round_Mode);
@@ -74,15 +98,20 @@ namespace BigInt
          bool infinity;
          bool nan;
 
+            // Division, where the divisor may already be set up to be divided by. It is only used if it needn't be rescaled.
+         static Fixed divide (const Fixed &, const Fixed &, const Fixed_Context &, Integer_Divisor *);
+
       public:
 
          Fixed (const Fixed & from) :
             Data (from.Data), Digits (from.Digits), infinity(from.infinity), nan(from.nan) { }
+         Fixed (Fixed && from) :
+            Data (std::move(from.Data)), Digits (from.Digits), infinity(from.infinity), nan(from.nan) { }
          Fixed (bool infinity, bool nan) :
             Data (), Digits (0U), infinity(infinity), nan(nan) { }
-         explicit Fixed (unsigned long precision = defPrec) :
+         explicit Fixed (unsigned long precision = context.precision) :
             Data (), Digits (precision), infinity(false), nan(false) { }
-         explicit Fixed (long long i, unsigned long p = defPrec) :
+         explicit Fixed (long long i, unsigned long p = context.precision) :
             Data (static_cast<long>(i)), Digits (p), infinity(false), nan(false) { } // Long long is used to assist the compiler.
          explicit Fixed (const std::string &);
          explicit Fixed (const char *);
@@ -93,6 +122,7 @@ namespace BigInt
             { return (Digits = newPrecision); }
 
          void changePrecision (unsigned long); //changes Data to match
+         void changePrecision (unsigned long, Fixed_Round_Mode);
 
          bool isSigned (void) const { return !infinity && !nan && Data.isSigned(); }
          bool isZero (void) const { return !infinity && !nan && Data.isZero(); }
@@ -101,6 +131,8 @@ namespace BigInt
          bool isNaN (void) const { return nan; }
 
          std::string toString (void) const;
+            // At least the first length characters of toString() (or all of it), without converting every digit of a huge number.
+         std::string leadingString (size_t length) const;
 
          void fromString (const std::string & src)
             { fromString(src.c_str()); }
@@ -111,7 +143,22 @@ namespace BigInt
          friend Fixed operator * (const Fixed &, const Fixed &);
          friend Fixed operator / (const Fixed &, const Fixed &);
 
+            // Multiplication and division with an explicit context, rather than this thread's.
+         static Fixed multiply (const Fixed &, const Fixed &, const Fixed_Context &);
+         static Fixed divide (const Fixed &, const Fixed &, const Fixed_Context &);
+            // The product of the first two plus the third: the same as doing it in two steps, without the number in between.
+         static Fixed multiplyAdd (const Fixed &, const Fixed &, const Fixed &, const Fixed_Context &);
+            // The square root, correctly rounded to the context's scale in its rounding mode. The root of a negative number is NaN.
+         static Fixed squareRoot (const Fixed &, const Fixed_Context &);
+
          Fixed & operator = (const Fixed &) = default;
+         Fixed & operator = (Fixed &&) = default;
+
+            // The same as the operators above, but reusing this number's storage when nothing else shares it.
+         Fixed & operator += (const Fixed &);
+         Fixed & operator -= (const Fixed &);
+         Fixed & operator *= (const Fixed &);
+         Fixed & operator /= (const Fixed &);
 
          Fixed operator - (void) const;
          bool operator ! (void) const { return isZero(); }
@@ -121,8 +168,80 @@ namespace BigInt
          Integer roundToInteger (void) const;
          Fixed roundToInteger (Fixed_Round_Mode) const;
 
+         friend class Fixed_Accumulator;
+         friend class Fixed_Divisor;
+
     }; /* class Fixed */
 
+      /*
+         Adds up any number of Fixed, and gets what adding them up in order with operator + gets:
+         the sum has the largest scale of any addend, and NaN and Infinity come out the same.
+         The sum is kept in one number, which each addend is added into in place.
+      */
+   class Fixed_Accumulator final
+    {
+
+      private:
+         Integer_Accumulator Data;
+         unsigned long Digits;
+
+         Fixed Special; // Once a NaN or Infinity is added, this is the sum.
+         bool special;
+
+      public:
+         explicit Fixed_Accumulator (unsigned long precision = 0U) : // Starts at zero, with this scale.
+            Data (), Digits (precision), Special (false, false), special (false) { }
+
+         Fixed_Accumulator (const Fixed_Accumulator &) = delete;
+         Fixed_Accumulator & operator = (const Fixed_Accumulator &) = delete;
+
+         Fixed_Accumulator & operator += (const Fixed &);
+         void addProduct (const Fixed &, const Fixed &, const Fixed_Context &); // Add what Fixed::multiply gives.
+
+         Fixed get (void) const;
+
+    }; /* class Fixed_Accumulator */
+
+      /*
+         Divides by the same Fixed over and over, and gets what Fixed::divide gets.
+         Its Integer_Divisor is used whenever the divisor doesn't have to be rescaled to the dividend.
+      */
+   class Fixed_Divisor final
+    {
+
+      private:
+         Fixed Divisor;
+         Integer_Divisor Data;
+
+      public:
+         Fixed_Divisor () : Divisor (0UL), Data (Integer()) { } // Dividing by zero, until reset.
+         explicit Fixed_Divisor (const Fixed & divisor) : Divisor (divisor), Data (divisor.Data) { }
+
+         Fixed_Divisor (const Fixed_Divisor &) = delete;
+         Fixed_Divisor & operator = (const Fixed_Divisor &) = delete;
+
+         void reset (const Fixed & divisor) { Divisor = divisor; Data.reset(divisor.Data); } // Divide by this instead.
+         bool matches (const Fixed &) const; // Is this the same value, at the same scale?
+         Fixed divide (const Fixed &, const Fixed_Context &);
+
+    }; /* class Fixed_Divisor */
+
+      // Use a context on this thread for as long as this exists, then put the old one back.
+   class Fixed_Context_Holder final
+    {
+
+      private:
+         Fixed_Context saved;
+
+      public:
+         explicit Fixed_Context_Holder (const Fixed_Context & use) : saved(Fixed::setContext(use)) { }
+         ~Fixed_Context_Holder () { (void) Fixed::setContext(saved); }
+
+         Fixed_Context_Holder (const Fixed_Context_Holder &) = delete;
+         Fixed_Context_Holder & operator = (const Fixed_Context_Holder &) = delete;
+
+    }; /* class Fixed_Context_Holder */
+
    Fixed operator + (const Fixed &, const Fixed &);
    Fixed operator - (const Fixed &, const Fixed &);
    Fixed operator * (const Fixed &, const Fixed &);
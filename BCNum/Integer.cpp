@@ -29,11 +29,224 @@ SUCH DAMAGE.
 
 #include "Integer.hpp"
 #include <gmp.h>
+#include <algorithm>
+#include <climits>
+#include <cmath>
 #include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
 
 namespace BigInt
  {
 
+    /*
+      GMP gets its limb storage from these functions rather than straight from malloc.
+      Each thread keeps the blocks it frees, in a few sizes, and hands them out again: a recalc frees
+      about as much as it allocates, so after the first few cells it hardly calls malloc at all.
+      A thread's blocks go back to malloc when the thread ends, or when it asks with releasePooledMemory.
+    */
+   static const size_t SMALLEST_BLOCK = 16U; // Blocks are a power of two bytes, from this...
+   static const size_t BLOCK_SIZES = 9U; // ...up to 4096 bytes. Anything bigger comes from malloc.
+   static const size_t BLOCKS_KEPT = 128U; // For each size. Beyond this, a freed block goes back to malloc.
+
+   static size_t sizeClass (size_t size)
+    {
+      size_t which = 0U;
+      while ((which < BLOCK_SIZES) && ((SMALLEST_BLOCK << which) < size)) ++which;
+      return which;
+    }
+
+   static thread_local bool poolFinished = false; // Trivially destructible, so it can be read while the thread ends.
+
+   class LimbPool final
+    {
+   private:
+      std::vector<void*> blocks [BLOCK_SIZES];
+
+   public:
+      LimbPool () { }
+
+      ~LimbPool ()
+       {
+         release();
+         poolFinished = true;
+       }
+
+      void* take (size_t which)
+       {
+         if (true == blocks[which].empty()) return nullptr;
+         void* result = blocks[which].back();
+         blocks[which].pop_back();
+         return result;
+       }
+
+      bool keep (size_t which, void* block)
+       {
+         if (blocks[which].size() >= BLOCKS_KEPT) return false;
+         if (blocks[which].capacity() < BLOCKS_KEPT) blocks[which].reserve(BLOCKS_KEPT);
+         blocks[which].push_back(block);
+         return true;
+       }
+
+      void release (void)
+       {
+         for (std::vector<void*>& list : blocks)
+          {
+            for (void* block : list)
+             {
+               std::free(block);
+             }
+            std::vector<void*>().swap(list);
+          }
+       }
+
+      static LimbPool* get (void)
+       {
+         if (true == poolFinished) return nullptr;
+         static thread_local LimbPool pool;
+         return &pool;
+       }
+    };
+
+    /*
+      A giant number's limbs get pages of their own, rather than a block from malloc.
+      On Linux, they are an anonymous mapping that asks for huge pages, and growing one moves its pages
+      with mremap instead of copying gigabytes. Elsewhere, this is just malloc.
+    */
+   static const size_t MAPPED_BLOCK = static_cast<size_t>(2U) << 20; // Two megabytes: one huge page.
+
+#if defined(__linux__)
+   static size_t mappedSize (size_t size)
+    {
+      return (size + MAPPED_BLOCK - 1U) & ~(MAPPED_BLOCK - 1U);
+    }
+
+   static void* mapBlock (size_t size)
+    {
+      void* result = mmap(nullptr, mappedSize(size), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (MAP_FAILED == result) throw std::bad_alloc();
+#if defined(MADV_HUGEPAGE)
+      (void) madvise(result, mappedSize(size), MADV_HUGEPAGE); // Only advice: without huge pages, it is still a mapping.
+#endif
+      return result;
+    }
+
+   static void* remapBlock (void* block, size_t oldSize, size_t newSize)
+    {
+      if (mappedSize(oldSize) == mappedSize(newSize)) return block;
+      void* result = mremap(block, mappedSize(oldSize), mappedSize(newSize), MREMAP_MAYMOVE);
+      if (MAP_FAILED == result) throw std::bad_alloc();
+      return result;
+    }
+
+   static void unmapBlock (void* block, size_t size)
+    {
+      (void) munmap(block, mappedSize(size));
+    }
+#else
+   static void* mapBlock (size_t size)
+    {
+      void* result = std::malloc(size);
+      if (nullptr == result) throw std::bad_alloc();
+      return result;
+    }
+
+   static void* remapBlock (void* block, size_t, size_t newSize)
+    {
+      void* result = std::realloc(block, newSize);
+      if (nullptr == result) throw std::bad_alloc();
+      return result;
+    }
+
+   static void unmapBlock (void* block, size_t)
+    {
+      std::free(block);
+    }
+#endif
+
+   static void* poolAllocate (size_t size)
+    {
+      if (size >= MAPPED_BLOCK) return mapBlock(size);
+
+      const size_t which = sizeClass(size);
+      void* result = nullptr;
+      if (which < BLOCK_SIZES)
+       {
+         LimbPool* pool = LimbPool::get();
+         if (nullptr != pool) result = pool->take(which);
+         size = SMALLEST_BLOCK << which;
+       }
+      if (nullptr == result)
+       {
+         result = std::malloc(size);
+         if (nullptr == result) throw std::bad_alloc();
+       }
+      return result;
+    }
+
+   static void poolFree (void* block, size_t size)
+    {
+      if (size >= MAPPED_BLOCK)
+       {
+         unmapBlock(block, size);
+         return;
+       }
+
+      const size_t which = sizeClass(size);
+      if (which < BLOCK_SIZES)
+       {
+         LimbPool* pool = LimbPool::get();
+         if ((nullptr != pool) && (true == pool->keep(which, block))) return;
+       }
+      std::free(block);
+    }
+
+   static void* poolReallocate (void* block, size_t oldSize, size_t newSize)
+    {
+      const bool oldMapped = (oldSize >= MAPPED_BLOCK), newMapped = (newSize >= MAPPED_BLOCK);
+      if (oldMapped && newMapped) return remapBlock(block, oldSize, newSize);
+
+      const size_t oldClass = sizeClass(oldSize), newClass = sizeClass(newSize);
+      if ((oldClass == newClass) && (oldClass < BLOCK_SIZES)) return block; // It already fits.
+      if ((oldClass == BLOCK_SIZES) && (newClass == BLOCK_SIZES) && !oldMapped && !newMapped)
+       {
+         void* result = std::realloc(block, newSize);
+         if (nullptr == result) throw std::bad_alloc();
+         return result;
+       }
+      void* result = poolAllocate(newSize);
+      std::memcpy(result, block, (oldSize < newSize) ? oldSize : newSize);
+      poolFree(block, oldSize);
+      return result;
+    }
+
+    /*
+      BCNum owns GMP's allocator: a program that uses it mustn't call mp_set_memory_functions itself.
+      The pools are installed while the program starts, before anything can have made a GMP number with malloc:
+      a block from malloc that was freed into a pool would be handed out again as the whole size of its class.
+      The holders below install them too, in case a number is made while another file's statics are being made.
+    */
+   static void usePools (void)
+    {
+      static const bool installed = (mp_set_memory_functions(&poolAllocate, &poolReallocate, &poolFree), true);
+      (void) installed;
+    }
+
+   static const bool poolsInstalled = (usePools(), true);
+
+   void releasePooledMemory (void)
+    {
+      LimbPool* pool = LimbPool::get();
+      if (nullptr != pool) pool->release();
+    }
+
    class DataHolder final
     {
    public:
@@ -41,6 +254,7 @@ namespace BigInt
 
       DataHolder ()
        {
+         usePools();
          mpz_init(Data);
        }
 
@@ -49,42 +263,222 @@ namespace BigInt
          mpz_clear(Data);
        }
 
-      explicit DataHolder (unsigned long src)
-       {
-         mpz_init_set_ui(Data, src);
-       }
-
       explicit DataHolder (const char* src)
        {
+         usePools();
          mpz_init_set_str(Data, src, 10);
        }
     };
 
-   Integer::Integer () : Sign (false) { }
+   class SumHolder final
+    {
+   public:
+      mpz_t Sum; // Signed, unlike an Integer's Data.
+      mpz_t Power; // Ten to the Exponent: the last power used is usually the next one used.
+      mpz_t Scaled;
+      unsigned long Exponent;
+
+      SumHolder () : Exponent (0U)
+       {
+         usePools();
+         mpz_init(Sum);
+         mpz_init_set_ui(Power, 1U);
+         mpz_init(Scaled);
+       }
+
+      ~SumHolder ()
+       {
+         mpz_clear(Sum);
+         mpz_clear(Power);
+         mpz_clear(Scaled);
+       }
+
+      void setPower (unsigned long power)
+       {
+         if (power != Exponent)
+          {
+            mpz_ui_pow_ui(Power, 10U, power);
+            Exponent = power;
+          }
+       }
+    };
 
-   Integer::Integer (unsigned long input) : Sign (false)
+      // A read-only mpz_t of an Integer's magnitude, wherever it is kept. A Small one is viewed in place: nothing is allocated.
+   class Magnitude final
     {
-      if (input != 0)
+   private:
+      mp_limb_t limbs [2];
+      mpz_t view;
+      mpz_srcptr value;
+
+   public:
+      explicit Magnitude (const Integer& from)
        {
-         Data = std::make_shared<DataHolder>((unsigned long)input);
+         if (nullptr != from.Data.get())
+          {
+            value = from.Data->Data;
+          }
+         else
+          {
+#if GMP_NUMB_BITS >= 64
+            limbs[0] = from.Small;
+            value = mpz_roinit_n(view, limbs, (0U != limbs[0]) ? 1 : 0);
+#else
+            limbs[0] = static_cast<mp_limb_t>(from.Small & 0xFFFFFFFFU);
+            limbs[1] = static_cast<mp_limb_t>(from.Small >> 32);
+            value = mpz_roinit_n(view, limbs, (0U != limbs[1]) ? 2 : ((0U != limbs[0]) ? 1 : 0));
+#endif
+          }
        }
+
+      Magnitude (const Magnitude&) = delete;
+      Magnitude& operator = (const Magnitude&) = delete;
+
+      mpz_srcptr get (void) const { return value; }
+    };
+
+      // Does the magnitude of src fit in an unsigned long long? Then put it there.
+   static bool toSmall (mpz_srcptr src, unsigned long long& dest)
+    {
+      if (mpz_sizeinbase(src, 2) > 64U) return false;
+      dest = 0U;
+      mpz_export(&dest, nullptr, -1, sizeof(dest), 0, 0, src);
+      return true;
     }
 
+      // Multiply two Small magnitudes, if the product fits.
+   static bool multiply (unsigned long long lhs, unsigned long long rhs, unsigned long long& product)
+    {
+#if defined(__GNUC__)
+      return !__builtin_mul_overflow(lhs, rhs, &product);
+#else
+      if (lhs > ULLONG_MAX / rhs) return false;
+      product = lhs * rhs;
+      return true;
+#endif
+    }
+
+   Integer::Integer () : Small (0U), Sign (false) { }
+
+   Integer::Integer (unsigned long input) : Small (input), Sign (false) { }
+
    Integer::~Integer ()
     {
       Sign = false;
     }
 
+   void Integer::adopt (const std::shared_ptr<DataHolder>& from)
+    {
+      int sign = mpz_sgn(from->Data);
+      Sign = (sign < 0);
+      Small = 0U;
+      Data.reset();
+      if (0 == sign) return;
+
+      if (!toSmall(from->Data, Small))
+       {
+         mpz_abs(from->Data, from->Data);
+         Data = from;
+       }
+    }
+
+
+   void Integer::settle (void)
+    {
+      if (0 == mpz_sgn(Data->Data))
+       {
+         Data.reset();
+         Sign = false;
+       }
+      else if (toSmall(Data->Data, Small))
+       {
+         Data.reset();
+       }
+    }
+
+   Integer& Integer::accumulate (const Integer& rhs, bool sign)
+    {
+      if ((nullptr == Data.get()) || (1 != Data.use_count()))
+       {
+         return *this = (sign == rhs.Sign) ? (*this + rhs) : (*this - rhs);
+       }
+      if (rhs.isZero()) return *this;
+
+      Magnitude right (rhs);
+      if (Sign == sign)
+       {
+         mpz_add(Data->Data, Data->Data, right.get());
+       }
+      else
+       {
+         mpz_sub(Data->Data, Data->Data, right.get());
+         if (mpz_sgn(Data->Data) < 0)
+          {
+            mpz_neg(Data->Data, Data->Data);
+            Sign = !Sign;
+          }
+       }
+      settle();
+      return *this;
+    }
+
+   Integer& Integer::addProduct (const Integer& lhs, const Integer& rhs)
+    {
+      if ((nullptr == Data.get()) || (1 != Data.use_count()))
+       {
+         return *this += lhs * rhs;
+       }
+      if (lhs.isZero() || rhs.isZero()) return *this;
+
+      Magnitude left (lhs), right (rhs);
+      if (Sign == (lhs.Sign ^ rhs.Sign))
+       {
+         mpz_addmul(Data->Data, left.get(), right.get());
+       }
+      else
+       {
+         mpz_submul(Data->Data, left.get(), right.get());
+         if (mpz_sgn(Data->Data) < 0)
+          {
+            mpz_neg(Data->Data, Data->Data);
+            Sign = !Sign;
+          }
+       }
+      settle();
+      return *this;
+    }
+
+   Integer& Integer::operator *= (const Integer& rhs)
+    {
+      if ((nullptr == Data.get()) || (1 != Data.use_count()))
+       {
+         return *this = *this * rhs;
+       }
+      if (rhs.isZero()) return *this = Integer();
+
+      if ((nullptr == rhs.Data.get()) && (rhs.Small <= ULONG_MAX))
+       {
+         mpz_mul_ui(Data->Data, Data->Data, static_cast<unsigned long>(rhs.Small));
+       }
+      else
+       {
+         Magnitude right (rhs);
+         mpz_mul(Data->Data, Data->Data, right.get());
+       }
+      Sign = Sign ^ rhs.Sign; // Still too big for Small: nothing to settle.
+      return *this;
+    }
+
 
 
    bool Integer::isEven (void) const
     {
-      return isZero() ? true : mpz_even_p(Data->Data);
+      return (nullptr != Data.get()) ? mpz_even_p(Data->Data) : (0U == (Small & 1U));
     }
 
    bool Integer::is0mod5 (void) const
     {
-      return isZero() ? true : (0 != mpz_divisible_ui_p (Data->Data, 5U));
+      return (nullptr != Data.get()) ? (0 != mpz_divisible_ui_p (Data->Data, 5U)) : (0U == (Small % 5U));
     }
 
    Integer& Integer::negate (void)
@@ -102,8 +496,8 @@ namespace BigInt
 
    long Integer::toInt (void) const //It works for its purpose.
     {
-      if (isZero() || (0 == mpz_fits_sint_p(Data->Data))) return 0;
-      return Sign ? -mpz_get_si(Data->Data) : mpz_get_si(Data->Data);
+      if ((nullptr != Data.get()) || (Small > static_cast<unsigned long long>(INT_MAX))) return 0;
+      return Sign ? -static_cast<long>(Small) : static_cast<long>(Small);
     }
 
 
@@ -129,30 +523,28 @@ namespace BigInt
        }
 
        /*
-         Test for zeros, which are always positive.
+         Compare the magnitudes. Anything in Data is bigger than anything in Small.
        */
-      if (!Sign)
+      int result;
+      if (nullptr != Data.get())
        {
-         if (isZero())
-          {
-             // Both are Zero.
-            if (to.isZero()) return 0;
-             // I'm Zero, he isn't.
-            return -1;
-         }
-        if (to.isZero())
-         {
-            // I'm not zero.
-            return 1;
-         }
+         result = (nullptr != to.Data.get()) ? mpz_cmp(Data->Data, to.Data->Data) : 1;
+       }
+      else if (nullptr != to.Data.get())
+       {
+         result = -1;
+       }
+      else
+       {
+         result = (Small < to.Small) ? -1 : ((Small > to.Small) ? 1 : 0);
        }
 
        /*
          Return the unsigned comparison, remembering that if we are
          negative, then the result is negated.
        */
-      if (Sign) return -mpz_cmp(Data->Data, to.Data->Data);
-      return mpz_cmp(Data->Data, to.Data->Data);
+      if (Sign) return -result;
+      return result;
     }
 
 
@@ -170,128 +562,267 @@ namespace BigInt
          return rhs;
        }
 
-      result.Sign = lhs.Sign;
-      result.Data = std::make_shared<DataHolder>();
-
-      if (lhs.Sign == rhs.Sign) mpz_add(result.Data->Data, lhs.Data->Data, rhs.Data->Data);
-      else mpz_sub(result.Data->Data, lhs.Data->Data, rhs.Data->Data);
-
-      int sign = mpz_sgn(result.Data->Data);
-      switch (sign)
+      if ((nullptr == lhs.Data.get()) && (nullptr == rhs.Data.get()))
        {
-         case -1:
-            result.Sign = !result.Sign;
-            mpz_abs(result.Data->Data, result.Data->Data);
-            break;
+         if (lhs.Sign != rhs.Sign)
+          {
+            if (lhs.Small >= rhs.Small)
+             {
+               result.Small = lhs.Small - rhs.Small;
+               result.Sign = (0U != result.Small) && lhs.Sign;
+             }
+            else
+             {
+               result.Small = rhs.Small - lhs.Small;
+               result.Sign = rhs.Sign;
+             }
+            return result;
+          }
+         if (lhs.Small <= ULLONG_MAX - rhs.Small)
+          {
+            result.Small = lhs.Small + rhs.Small;
+            result.Sign = lhs.Sign;
+            return result;
+          }
+       }
 
-         case 0:
-            result.Sign = false;
-            result.Data.reset();
-            break;
+      Magnitude left (lhs), right (rhs);
+      std::shared_ptr<DataHolder> sum = std::make_shared<DataHolder>();
 
-         default:
-            break;
-       }
+      if (lhs.Sign == rhs.Sign) mpz_add(sum->Data, left.get(), right.get());
+      else mpz_sub(sum->Data, left.get(), right.get());
+      if (lhs.Sign) mpz_neg(sum->Data, sum->Data);
 
+      result.adopt(sum);
       return result;
     }
 
    Integer operator - (const Integer& lhs, const Integer& rhs)
+    {
+      return lhs + -rhs;
+    }
+
+   Integer operator * (const Integer& lhs, const Integer& rhs)
     {
       Integer result;
 
-      if (rhs.isZero())
+      if (lhs.isZero() || rhs.isZero())
        {
-         return lhs;
+         return result;
        }
-      if (lhs.isZero())
+
+      if ((nullptr == lhs.Data.get()) && (nullptr == rhs.Data.get()))
        {
-         return -rhs;
+         if (multiply(lhs.Small, rhs.Small, result.Small))
+          {
+            result.Sign = lhs.Sign ^ rhs.Sign;
+            return result;
+          }
        }
 
-      result.Sign = lhs.Sign;
-      result.Data = std::make_shared<DataHolder>();
+      Magnitude left (lhs), right (rhs);
+      std::shared_ptr<DataHolder> product = std::make_shared<DataHolder>();
 
-      if (lhs.Sign == rhs.Sign) mpz_sub(result.Data->Data, lhs.Data->Data, rhs.Data->Data);
-      else mpz_add(result.Data->Data, lhs.Data->Data, rhs.Data->Data);
+         // A factor that fits in one word, like a power of ten when rescaling, uses the single-limb multiply.
+      if ((nullptr == rhs.Data.get()) && (rhs.Small <= ULONG_MAX)) mpz_mul_ui(product->Data, left.get(), static_cast<unsigned long>(rhs.Small));
+      else if ((nullptr == lhs.Data.get()) && (lhs.Small <= ULONG_MAX)) mpz_mul_ui(product->Data, right.get(), static_cast<unsigned long>(lhs.Small));
+      else mpz_mul(product->Data, left.get(), right.get());
+
+      result.adopt(product);
+      result.Sign = lhs.Sign ^ rhs.Sign;
+      return result;
+    }
 
-      int sign = mpz_sgn(result.Data->Data);
-      switch (sign)
-       {
-         case -1:
-            result.Sign = !result.Sign;
-            mpz_abs(result.Data->Data, result.Data->Data);
-            break;
 
-         case 0:
-            result.Sign = false;
-            result.Data.reset();
-            break;
 
-         default:
-            break;
+   void Integer::fromString (const std::string& src)
+    {
+      fromString(src.c_str());
+    }
+
+   void Integer::fromString (const char* src)
+    {
+         // Plain digits that fit in Small are read in place. GMP reads anything longer faster than fromDigits,
+         // which is for digits split around a decimal point.
+      const char* digits = ('-' == *src) ? src + 1 : src;
+      size_t length = std::strlen(digits);
+      if ((0U != length) && (length <= 19U) && (length == std::strspn(digits, "0123456789")))
+       {
+         fromDigits(digits, length);
+         if (digits != src) negate();
+         return;
        }
 
-      return result;
+      adopt(std::make_shared<DataHolder>(src));
     }
 
-   Integer operator * (const Integer& lhs, const Integer& rhs)
+
+
+   static const size_t WORD_DIGITS = (ULONG_MAX > 0xFFFFFFFFUL) ? 19U : 9U; // The most digits that always fit in an unsigned long.
+   static const unsigned long WORD_POWER = static_cast<unsigned long>((ULONG_MAX > 0xFFFFFFFFUL) ? 10000000000000000000ULL : 1000000000ULL);
+   static const size_t HORNER_DIGITS = 1000U; // Up to this many, read a word at a time. Past it, split the digits in halves.
+
+      // The digits of a number, maybe split in two around a decimal point.
+   class DigitRun final
     {
-      Integer result;
+   public:
+      const char* first;
+      size_t firstLength;
+      const char* second;
 
-      if (lhs.isZero() || rhs.isZero())
+      char operator [] (size_t index) const { return (index < firstLength) ? first[index] : second[index - firstLength]; }
+
+      unsigned long word (size_t begin, size_t length) const
        {
+         unsigned long result = 0U;
+         for (size_t i = begin; i < begin + length; ++i)
+          {
+            result = result * 10U + static_cast<unsigned long>((*this)[i] - '0');
+          }
          return result;
        }
+    };
 
-      result.Data = std::make_shared<DataHolder>();
-      mpz_mul(result.Data->Data, lhs.Data->Data, rhs.Data->Data);
-      result.Sign = lhs.Sign ^ rhs.Sign;
-
-      return result;
+   static void readShort (mpz_t result, const DigitRun& digits, size_t begin, size_t length)
+    {
+      size_t head = length % WORD_DIGITS; // Read the odd digits first, so that the rest are whole words.
+      if (0U == head) head = WORD_DIGITS;
+      mpz_set_ui(result, digits.word(begin, head));
+      for (size_t i = begin + head; i < begin + length; i += WORD_DIGITS)
+       {
+         mpz_mul_ui(result, result, WORD_POWER);
+         mpz_add_ui(result, result, digits.word(i, WORD_DIGITS));
+       }
     }
 
-
-
-   void Integer::fromString (const std::string& src)
+      // The length is at most HORNER_DIGITS << level, and powers[j] is ten to the (HORNER_DIGITS << j).
+   static void readLong (mpz_t result, const DigitRun& digits, size_t begin, size_t length,
+                         const std::vector<std::unique_ptr<DataHolder> >& powers, size_t level)
     {
-      fromString(src.c_str());
+      if (0U == level)
+       {
+         readShort(result, digits, begin, length);
+         return;
+       }
+      const size_t half = HORNER_DIGITS << (level - 1U);
+      if (length <= half)
+       {
+         readLong(result, digits, begin, length, powers, level - 1U);
+         return;
+       }
+      DataHolder low;
+      readLong(result, digits, begin, length - half, powers, level - 1U);
+      readLong(low.Data, digits, begin + length - half, half, powers, level - 1U);
+      mpz_mul(result, result, powers[level - 1U]->Data);
+      mpz_add(result, result, low.Data);
     }
 
-   void Integer::fromString (const char* src)
+   void Integer::fromDigits (const char* first, size_t firstLength, const char* second, size_t secondLength)
     {
       Sign = false;
-      Data = std::make_shared<DataHolder>(src);
+      Small = 0U;
+      Data.reset();
+
+      const DigitRun digits { first, firstLength, second };
+      const size_t length = firstLength + secondLength;
+      size_t begin = 0U;
+      while ((begin < length) && ('0' == digits[begin])) ++begin;
 
-      int sign = mpz_sgn(Data->Data);
-      switch (sign)
+      if (length - begin <= 19U)
        {
-         case -1:
-            Sign = true;
-            mpz_abs(Data->Data, Data->Data);
-            break;
+         for (size_t i = begin; i < length; ++i)
+          {
+            Small = Small * 10U + static_cast<unsigned long long>(digits[i] - '0');
+          }
+         return;
+       }
 
-         case 0:
-            Data.reset();
-            break;
+      std::vector<std::unique_ptr<DataHolder> > powers;
+      size_t level = 0U;
+      while ((HORNER_DIGITS << level) < length - begin)
+       {
+         powers.emplace_back(new DataHolder());
+         if (0U == level) mpz_set(powers.back()->Data, pow10(HORNER_DIGITS).Data->Data);
+         else mpz_mul(powers.back()->Data, powers[level - 1U]->Data, powers[level - 1U]->Data);
+         ++level;
+       }
 
-         default:
-            break;
+      std::shared_ptr<DataHolder> result = std::make_shared<DataHolder>();
+      readLong(result->Data, digits, begin, length - begin, powers, level);
+      adopt(result);
+    }
+
+
+
+   static size_t smallDigits (unsigned long long value, char* buffer)
+    {
+      char reversed [20];
+      size_t length = 0U;
+      do
+       {
+         reversed[length++] = static_cast<char>('0' + value % 10U);
+         value /= 10U;
        }
+      while (0U != value);
+      for (size_t i = 0U; i < length; ++i)
+       {
+         buffer[i] = reversed[length - 1U - i];
+       }
+      buffer[length] = '\0';
+      return length;
     }
 
+   size_t Integer::maxDigits (void) const
+    {
+      if (nullptr == Data.get()) return 20U; // The digits in ULLONG_MAX
+      return mpz_sizeinbase(Data->Data, 10);
+    }
 
+   size_t Integer::toDigits (char * buffer) const
+    {
+      if (nullptr == Data.get()) return smallDigits(Small, buffer);
+
+      mpz_get_str(buffer, 10, Data->Data);
+      return std::strlen(buffer);
+    }
 
    std::string Integer::toString () const
     {
-      std::string result;
+      const size_t sign = isSigned() ? 1U : 0U;
+      std::string result (sign + maxDigits() + 1U, '-');
 
-      if (isZero()) return std::string("0");
-      if (isSigned()) result = "-";
+      result.resize(sign + toDigits(&result[sign]));
 
-      char * rstring = mpz_get_str(nullptr, 10, Data->Data);
-      result += rstring;
-      std::free(rstring);
+      return result;
+    }
+
+   static const size_t EXACT_DIGITS = 10000U; // Up to this many digits, just convert the whole number.
+   static const size_t GUARD_DIGITS = 20U; // Extra digits worked out, so that the ones we keep are right.
+
+   std::string Integer::leadingDigits (size_t count, size_t& total) const
+    {
+      const size_t most = maxDigits();
+      if ((nullptr == Data.get()) || (most <= count + EXACT_DIGITS))
+       {
+         std::string result (most + 1U, '\0');
+         total = toDigits(&result[0]);
+         result.resize(std::min(total, count));
+         return result;
+       }
+
+         // Convert only the leading limbs, as a float. GMP scales it by a power of ten of the same low precision.
+      mpf_t approximate;
+      mp_exp_t exponent;
+      mpf_init2(approximate, static_cast<mp_bitcnt_t>((count + GUARD_DIGITS) * 4U)); // Four bits a digit is more than enough.
+      mpf_set_z(approximate, Data->Data);
+      char * rstring = mpf_get_str(nullptr, &exponent, 10, count + GUARD_DIGITS, approximate);
+      mpf_clear(approximate);
+
+      const size_t length = std::strlen(rstring); // Trailing zeros are dropped.
+      std::string result (rstring, std::min(length, count));
+      poolFree(rstring, length + 1U);
+      result.resize(count, '0');
+      total = static_cast<size_t>(exponent);
 
       return result;
     }
@@ -317,45 +848,454 @@ namespace BigInt
       bool
          qSign = lhs.isSigned() ^ rhs.isSigned(),
          rSign = lhs.isSigned();
+
+      if ((nullptr == lhs.Data.get()) && (nullptr == rhs.Data.get()))
+       {
+         unsigned long long
+            quot = lhs.Small / rhs.Small,
+            rem = lhs.Small % rhs.Small;
+
+         q = Integer();
+         r = Integer();
+
+         q.Small = quot;
+         q.Sign = (0U != quot) && qSign;
+         r.Small = rem;
+         r.Sign = (0U != rem) && rSign;
+         return;
+       }
+
       std::shared_ptr<DataHolder> quot, rem;
 
       quot = std::make_shared<DataHolder>();
+
+         // A divisor that fits in one word, like a power of ten when rescaling, uses the single-limb divide.
+      if ((nullptr == rhs.Data.get()) && (rhs.Small <= ULONG_MAX))
+       {
+         unsigned long word;
+          {
+            Magnitude left (lhs);
+            word = mpz_tdiv_q_ui(quot->Data, left.get(), static_cast<unsigned long>(rhs.Small));
+          }
+
+         q = Integer();
+         r = Integer();
+
+         q.adopt(quot);
+         q.Sign = !q.isZero() && qSign;
+         r.Small = word;
+         r.Sign = (0U != word) && rSign;
+         return;
+       }
+
       rem = std::make_shared<DataHolder>();
 
-      mpz_tdiv_qr(quot->Data, rem->Data, lhs.Data->Data, rhs.Data->Data);
+       {
+         Magnitude left (lhs), right (rhs);
+         mpz_tdiv_qr(quot->Data, rem->Data, left.get(), right.get());
+       }
 
       q = Integer();
       r = Integer();
 
-      int sign = mpz_sgn(quot->Data);
-      if (0 != sign)
+      q.adopt(quot);
+      q.Sign = !q.isZero() && qSign;
+      r.adopt(rem);
+      r.Sign = !r.isZero() && rSign;
+    }
+
+
+
+      // The square root of the double is within a few of the integer one: the loops make it exact.
+   static unsigned long long smallSqrt (unsigned long long radicand)
+    {
+      static const unsigned long long LARGEST_ROOT = 0xFFFFFFFFULL;
+      unsigned long long root = static_cast<unsigned long long>(std::sqrt(static_cast<double>(radicand)));
+      if (root > LARGEST_ROOT)
+         root = LARGEST_ROOT;
+      while (root * root > radicand)
+         --root;
+      while ((root < LARGEST_ROOT) && ((root + 1U) * (root + 1U) <= radicand))
+         ++root;
+      return root;
+    }
+
+   void sqrtrem (const Integer& radicand, Integer& root, Integer& rem)
+    {
+      if (nullptr == radicand.Data.get())
+       {
+         unsigned long long
+            s = smallSqrt(radicand.Small),
+            left = radicand.Small - s * s;
+
+         root = Integer();
+         rem = Integer();
+
+         root.Small = s;
+         rem.Small = left;
+         return;
+       }
+
+      std::shared_ptr<DataHolder> whole, left;
+
+      whole = std::make_shared<DataHolder>();
+      left = std::make_shared<DataHolder>();
+
+       {
+         Magnitude from (radicand);
+         mpz_sqrtrem(whole->Data, left->Data, from.get());
+       }
+
+      root = Integer();
+      rem = Integer();
+
+      root.adopt(whole);
+      rem.adopt(left);
+    }
+
+
+
+   static const size_t RECIPROCAL_LIMBS = 1000U; // For a smaller divisor, GMP's own division is faster.
+   static const mp_bitcnt_t RECIPROCAL_SLACK = 64U; // Extra bits of reciprocal, so that a little longer dividend can use it too.
+
+   class DivisorHolder final
+    {
+   public:
+      mpz_t Reciprocal; // Two to the (bits in the divisor + Length), over the divisor: rounded down.
+      mpz_t Truncated; // The reciprocal, cut short for a much shorter dividend.
+      mpz_t Top; // The top of the dividend.
+      mp_bitcnt_t Length; // The reciprocal serves any quotient shorter than this many bits.
+
+      DivisorHolder () : Length (0U)
+       {
+         usePools();
+         mpz_init(Reciprocal);
+         mpz_init(Truncated);
+         mpz_init(Top);
+       }
+
+      ~DivisorHolder ()
+       {
+         mpz_clear(Reciprocal);
+         mpz_clear(Truncated);
+         mpz_clear(Top);
+       }
+
+      DivisorHolder (const DivisorHolder&) = delete;
+      DivisorHolder& operator = (const DivisorHolder&) = delete;
+    };
+
+   Integer_Divisor::Integer_Divisor (const Integer& divisor) : Divisor (divisor), Data (), Uses (0U) { }
+
+   Integer_Divisor::~Integer_Divisor () { }
+
+   void Integer_Divisor::reset (const Integer& divisor)
+    {
+      Divisor = divisor;
+      Data.reset();
+      Uses = 0U;
+    }
+
+   void Integer_Divisor::quotrem (const Integer& dividend, Integer& quotient, Integer& remainder)
+    {
+      if ((nullptr == Divisor.Data.get()) || (mpz_size(Divisor.Data->Data) < RECIPROCAL_LIMBS) ||
+         (nullptr == dividend.Data.get()) || (mpz_cmp(dividend.Data->Data, Divisor.Data->Data) < 0) || (1U == ++Uses))
+       {
+         BigInt::quotrem(dividend, Divisor, quotient, remainder);
+         return;
+       }
+
+      mpz_srcptr divisor = Divisor.Data->Data;
+      const mp_bitcnt_t bits = mpz_sizeinbase(divisor, 2);
+      const mp_bitcnt_t length = mpz_sizeinbase(dividend.Data->Data, 2) - bits + 1U; // The dividend is under 2^(bits + length).
+
+      if (nullptr == Data.get())
+       {
+         Data.reset(new DivisorHolder());
+       }
+      if (length > Data->Length)
+       {
+         Data->Length = length + RECIPROCAL_SLACK;
+         mpz_set_ui(Data->Top, 0U);
+         mpz_setbit(Data->Top, bits + Data->Length);
+         mpz_tdiv_q(Data->Reciprocal, Data->Top, divisor);
+       }
+      mpz_srcptr reciprocal = Data->Reciprocal;
+      mp_bitcnt_t used = Data->Length;
+      if (used > length + 2U * RECIPROCAL_SLACK)
+       {
+            // Dropping low bits of the reciprocal gives the reciprocal for the shorter length, exactly.
+         mpz_tdiv_q_2exp(Data->Truncated, Data->Reciprocal, used - length);
+         reciprocal = Data->Truncated;
+         used = length;
+       }
+
+         // Barrett's estimate of the quotient is never over, and at most two under.
+      const bool qSign = dividend.Sign ^ Divisor.Sign, rSign = dividend.Sign;
+      std::shared_ptr<DataHolder> quot = std::make_shared<DataHolder>(), rem = std::make_shared<DataHolder>();
+      mpz_tdiv_q_2exp(Data->Top, dividend.Data->Data, bits - 1U);
+      mpz_mul(quot->Data, Data->Top, reciprocal);
+      mpz_tdiv_q_2exp(quot->Data, quot->Data, used + 1U);
+      mpz_mul(rem->Data, quot->Data, divisor);
+      mpz_sub(rem->Data, dividend.Data->Data, rem->Data);
+      while (mpz_cmp(rem->Data, divisor) >= 0)
+       {
+         mpz_sub(rem->Data, rem->Data, divisor);
+         mpz_add_ui(quot->Data, quot->Data, 1U);
+       }
+
+      quotient = Integer();
+      remainder = Integer();
+
+      quotient.adopt(quot);
+      quotient.Sign = !quotient.isZero() && qSign;
+      remainder.adopt(rem);
+      remainder.Sign = !remainder.isZero() && rSign;
+    }
+
+
+
+   Integer_Accumulator::Integer_Accumulator () : Data (new SumHolder()) { }
+
+   Integer_Accumulator::~Integer_Accumulator () { }
+
+   void Integer_Accumulator::add (const Integer& addend, unsigned long power)
+    {
+      if (addend.isZero()) return;
+
+      Magnitude value (addend);
+      if (0U == power)
+       {
+         if (addend.Sign) mpz_sub(Data->Sum, Data->Sum, value.get());
+         else mpz_add(Data->Sum, Data->Sum, value.get());
+       }
+      else
        {
-         q.Data = quot;
-         q.Sign = qSign;
+         Data->setPower(power);
+         if (addend.Sign) mpz_submul(Data->Sum, value.get(), Data->Power);
+         else mpz_addmul(Data->Sum, value.get(), Data->Power);
        }
+    }
+
+   void Integer_Accumulator::addProduct (const Integer& lhs, const Integer& rhs, unsigned long power)
+    {
+      if (lhs.isZero() || rhs.isZero()) return;
+
+      Magnitude left (lhs), right (rhs);
+      mpz_srcptr first = left.get();
+      if (0U != power)
+       {
+         Data->setPower(power);
+         mpz_mul(Data->Scaled, first, Data->Power);
+         first = Data->Scaled;
+       }
+
+      if (lhs.Sign ^ rhs.Sign) mpz_submul(Data->Sum, first, right.get());
+      else mpz_addmul(Data->Sum, first, right.get());
+    }
+
+   void Integer_Accumulator::scale (unsigned long power)
+    {
+      if (0U == power) return;
 
-      sign = mpz_sgn(rem->Data);
+      Data->setPower(power);
+      mpz_mul(Data->Sum, Data->Sum, Data->Power);
+    }
+
+   Integer Integer_Accumulator::get (void) const
+    {
+      Integer result;
+
+      int sign = mpz_sgn(Data->Sum);
       if (0 != sign)
        {
-         r.Data = rem;
-         r.Sign = rSign;
+         if (!toSmall(Data->Sum, result.Small))
+          {
+            result.Data = std::make_shared<DataHolder>();
+            mpz_abs(result.Data->Data, Data->Sum);
+          }
+         result.Sign = (sign < 0);
        }
+
+      return result;
     }
 
 
 
+   static const unsigned long long SMALL_POWERS [20] = // Every power of ten that fits in an unsigned long long.
+    {
+      1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+      10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+      1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+    };
+
+   static const unsigned long CACHED_POWER = 4096U; // Larger powers are made each time they are needed, and not kept.
+   static const size_t CACHED_COUNT = 64U; // The most powers kept: past this, the one used longest ago is dropped.
+
+      // Powers of ten that are shared by every thread.
+      // The lock is only held to look in the cache: a power is computed outside of it.
+   class PowerCache final
+    {
+   private:
+      class Entry final
+       {
+      public:
+         Integer value;
+         unsigned long long lastUsed;
+       };
+
+      std::mutex lock;
+      std::map<unsigned long, Entry> entries;
+      unsigned long long clock;
+
+   public:
+      PowerCache() : clock(0U) { }
+
+      bool find (unsigned long power, Integer& result)
+       {
+         std::lock_guard<std::mutex> guard (lock);
+         std::map<unsigned long, Entry>::iterator found = entries.find(power);
+         if (entries.end() == found) return false;
+         found->second.lastUsed = ++clock;
+         result = found->second.value;
+         return true;
+       }
+
+      void insert (unsigned long power, const Integer& value)
+       {
+         std::lock_guard<std::mutex> guard (lock);
+         if (entries.end() != entries.find(power)) return; // Another thread made it first.
+         if (entries.size() >= CACHED_COUNT)
+          {
+            std::map<unsigned long, Entry>::iterator oldest = entries.begin();
+            for (std::map<unsigned long, Entry>::iterator iter = entries.begin(); entries.end() != iter; ++iter)
+             {
+               if (iter->second.lastUsed < oldest->second.lastUsed) oldest = iter;
+             }
+            entries.erase(oldest);
+          }
+         Entry& entry = entries[power];
+         entry.value = value;
+         entry.lastUsed = ++clock;
+       }
+    };
+
    Integer pow10 (unsigned long power)
     {
-      Integer result, ten;
+      Integer result;
 
-      if (0U == power) return Integer(1U);
+      if (power < sizeof(SMALL_POWERS) / sizeof(SMALL_POWERS[0]))
+       {
+         result.Small = SMALL_POWERS[power];
+         return result;
+       }
 
-      ten = Integer(10U);
-      result.Data = std::make_shared<DataHolder>();
+         // The cache is never freed, so that it outlives anything that uses it while the program exits.
+      static PowerCache* cache = new PowerCache();
+      const bool kept = (power <= CACHED_POWER);
+      if ((true == kept) && (true == cache->find(power, result)))
+       {
+         return result;
+       }
 
-      mpz_pow_ui(result.Data->Data, ten.Data->Data, power);
+      std::shared_ptr<DataHolder> value = std::make_shared<DataHolder>();
+      mpz_ui_pow_ui(value->Data, 10U, power);
+      result.adopt(value);
+      if (true == kept) cache->insert(power, result);
 
       return result;
     }
 
+      // Each thread's space for the comparisons that must scale a number, so that they don't allocate.
+   class CompareScratch final
+    {
+   private:
+      static const size_t KEPT = 4096U; // Bytes: anything bigger goes back after use.
+      mpz_t Data;
+
+      CompareScratch ()
+       {
+         usePools();
+         mpz_init(Data);
+       }
+
+      static CompareScratch& getInstance (void)
+       {
+         static thread_local CompareScratch instance;
+         return instance;
+       }
+
+   public:
+      ~CompareScratch ()
+       {
+         mpz_clear(Data);
+       }
+
+      CompareScratch (const CompareScratch&) = delete;
+      CompareScratch& operator = (const CompareScratch&) = delete;
+
+      static mpz_ptr get (void) { return getInstance().Data; }
+
+      static void trim (void)
+       {
+         CompareScratch& instance = getInstance();
+         if (mpz_size(instance.Data) * sizeof(mp_limb_t) > KEPT)
+          {
+            mpz_clear(instance.Data);
+            mpz_init(instance.Data);
+          }
+       }
+    };
+
+
+   static const double LOG2_10 = 3.321928094887362; // Bits in a decimal digit
+
+   int Integer::compareScaled (const Integer& to, unsigned long power) const
+    {
+      const int lhsSign = isZero() ? 0 : (Sign ? -1 : 1);
+      const int rhsSign = to.isZero() ? 0 : (to.Sign ? -1 : 1);
+      if (lhsSign != rhsSign) return (lhsSign < rhsSign) ? -1 : 1;
+      if ((0 == lhsSign) || (0U == power)) return compare(to);
+
+       /*
+         Both have the same sign: compare the magnitudes, and flip the answer if they are negative.
+       */
+      int result;
+      unsigned long long product;
+      if ((nullptr == Data.get()) && (nullptr == to.Data.get()) && (power < sizeof(SMALL_POWERS) / sizeof(SMALL_POWERS[0])))
+       {
+         if (multiply(to.Small, SMALL_POWERS[power], product))
+            result = (Small < product) ? -1 : ((Small > product) ? 1 : 0);
+         else
+            result = -1;
+       }
+      else
+       {
+         Magnitude lhs (*this), rhs (to);
+            // The lhs is in [2^(lhsBits - 1), 2^lhsBits), and the scaled rhs in [2^(rhsBits - 1 + power * LOG2_10), 2^(rhsBits + power * LOG2_10)).
+         const unsigned long long lhsBits = mpz_sizeinbase(lhs.get(), 2), rhsBits = mpz_sizeinbase(rhs.get(), 2);
+         const unsigned long long scaleLow = static_cast<unsigned long long>(power * LOG2_10) - 1U; // Give or take rounding
+         const unsigned long long scaleHigh = static_cast<unsigned long long>(power * LOG2_10) + 2U;
+         if (lhsBits + 1U <= rhsBits + scaleLow)
+          {
+            result = -1;
+          }
+         else if (lhsBits >= rhsBits + scaleHigh + 1U)
+          {
+            result = 1;
+          }
+         else
+          {
+               // Too close to call: scale the rhs into this thread's scratch space.
+            mpz_ptr scratch = CompareScratch::get();
+            Integer scale = pow10(power);
+            Magnitude by (scale);
+            mpz_mul(scratch, rhs.get(), by.get());
+            result = mpz_cmp(lhs.get(), scratch);
+            CompareScratch::trim();
+          }
+       }
+      return Sign ? -result : result;
+    }
+
  } /* namespace BigInt */
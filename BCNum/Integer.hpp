@@ -30,6 +30,8 @@ SUCH DAMAGE.
 /*
    An arbitrary precision integer class that is just a wrapper and holder for GMP.
    That the sign isn't the GMP sign is probably a hold-over from this code's pedigree.
+   A magnitude that fits in an unsigned long long is kept in the Integer itself, and GMP is only
+   brought in when a result doesn't fit: most numbers in a sheet are never big enough to need it.
 */
 
 #ifndef INTEGER_HPP
@@ -41,34 +43,64 @@ SUCH DAMAGE.
 namespace BigInt
  {
    class DataHolder;
+   class SumHolder;
+   class DivisorHolder;
+   class Magnitude;
 
    class Integer final
     {
 
       private:
-         std::shared_ptr<DataHolder> Data;
+         std::shared_ptr<DataHolder> Data; // Only used for a magnitude that doesn't fit in Small.
+         unsigned long long Small; // The magnitude, when there is no Data.
          bool Sign;
 
+         void adopt (const std::shared_ptr<DataHolder>&); // Take a signed result, moving it into Small if it fits.
+         void settle (void); // After changing Data in place: move it into Small if it now fits.
+         Integer& accumulate (const Integer&, bool sign); // Add the magnitude of the Integer, with the given sign.
+
       public:
          Integer ();
          explicit Integer (unsigned long);
          Integer (const Integer&) = default;
+         Integer (Integer&&) = default;
          ~Integer (); // Not default due to pimpl
 
          bool isSigned (void) const { return Sign; }
-         bool isZero (void) const { return nullptr == Data.get(); }
+         bool isZero (void) const { return (nullptr == Data.get()) && (0U == Small); }
          bool isEven (void) const;
          bool is0mod5 (void) const;
 
          std::string toString () const;
+         size_t maxDigits (void) const; // At least the number of digits in the magnitude.
+         size_t toDigits (char *) const; // Write the magnitude's digits and a NUL into maxDigits() + 1 chars; returns how many digits.
+          /*
+            The first count digits of the magnitude (all of them, if there are fewer), and how many digits it has.
+            This is for showing a number: past ten thousand digits, only the leading limbs are converted,
+            and when a long run of nines follows the last digit given, it may be rounded up.
+          */
+         std::string leadingDigits (size_t count, size_t& total) const;
 
          void fromString (const std::string&);
          void fromString (const char *);
+            // Read a run of digits where it lies, without copying it. It may be in two parts, as around a decimal point.
+         void fromDigits (const char * first, size_t firstLength, const char * second = nullptr, size_t secondLength = 0U);
 
          Integer& negate (void);
          Integer& abs (void);
 
          Integer& operator = (const Integer&) = default;
+         Integer& operator = (Integer&&) = default;
+
+          /*
+            These change the number in place when nothing else shares it, rather than making a new one.
+          */
+         Integer& operator += (const Integer& rhs) { return accumulate(rhs, rhs.Sign); }
+         Integer& operator -= (const Integer& rhs) { return accumulate(rhs, !rhs.Sign); }
+         Integer& operator *= (const Integer&);
+         Integer& increment (void) { return accumulate(Integer(1U), false); }
+         Integer& decrement (void) { return accumulate(Integer(1U), true); }
+         Integer& addProduct (const Integer&, const Integer&); // Add the product of the two, without making it first.
 
          Integer operator - (void) const;
          bool operator ! (void) const { return isZero(); }
@@ -76,6 +108,7 @@ namespace BigInt
          long toInt (void) const; //Not perfect, but not terrible.
 
          int compare (const Integer &) const;
+         int compareScaled (const Integer &, unsigned long power) const; // Compare to the Integer times ten to the power.
 
           /*
             Note: Aliased Behavior: DON'T ALIAS quotient and remainder
@@ -85,14 +118,82 @@ namespace BigInt
                                     Integer& quotient,
                                     Integer& remainder);
 
+          /*
+            The integer square root of the magnitude (the sign is ignored), and what is left over.
+            Note: Aliased Behavior: DON'T ALIAS root and remainder
+          */
+         friend void sqrtrem (const Integer& radicand,
+                                    Integer& root,
+                                    Integer& remainder);
+
          friend Integer pow10 (unsigned long);
 
          friend Integer operator + (const Integer&, const Integer&);
          friend Integer operator - (const Integer&, const Integer&);
          friend Integer operator * (const Integer&, const Integer&);
 
+         friend class Integer_Accumulator;
+         friend class Integer_Divisor;
+         friend class Magnitude;
+
     }; /* class Integer */
 
+      /*
+         A running sum of Integers, each multiplied by a power of ten first, kept in one number.
+         Adding to it changes that number in place, rather than making a new one as operator + does.
+      */
+   class Integer_Accumulator final
+    {
+
+      private:
+         std::unique_ptr<SumHolder> Data;
+
+      public:
+         Integer_Accumulator ();
+         ~Integer_Accumulator (); // Not default due to pimpl
+
+         Integer_Accumulator (const Integer_Accumulator&) = delete;
+         Integer_Accumulator& operator = (const Integer_Accumulator&) = delete;
+
+         void add (const Integer&, unsigned long power); // Add the Integer times ten to the power.
+         void addProduct (const Integer&, const Integer&, unsigned long power); // Add the product of the two times ten to the power.
+         void scale (unsigned long power); // Multiply the sum by ten to the power.
+
+         Integer get (void) const;
+
+    }; /* class Integer_Accumulator */
+
+      /*
+         A divisor that is used over and over. From its second use, dividing by it multiplies by its reciprocal,
+         which is made once, rather than dividing from scratch. That only pays for divisors of thousands of digits:
+         smaller ones are divided by as quotrem does. Either way, the quotient and remainder are what quotrem gives.
+      */
+   class Integer_Divisor final
+    {
+
+      private:
+         Integer Divisor;
+         std::unique_ptr<DivisorHolder> Data; // Made on the second use.
+         size_t Uses;
+
+      public:
+         explicit Integer_Divisor (const Integer&);
+         ~Integer_Divisor (); // Not default due to pimpl
+
+         void reset (const Integer&); // Divide by this instead.
+
+         Integer_Divisor (const Integer_Divisor&) = delete;
+         Integer_Divisor& operator = (const Integer_Divisor&) = delete;
+
+         const Integer& get (void) const { return Divisor; }
+
+          /*
+            Note: Aliased Behavior: DON'T ALIAS quotient and remainder
+          */
+         void quotrem (const Integer& dividend, Integer& quotient, Integer& remainder);
+
+    }; /* class Integer_Divisor */
+
    Integer operator + (const Integer&, const Integer&);
    Integer operator - (const Integer&, const Integer&);
    Integer operator * (const Integer&, const Integer&);
@@ -100,6 +201,14 @@ namespace BigInt
    Integer pow10 (unsigned long);
 
    void quotrem (const Integer&, const Integer&, Integer&, Integer&);
+   void sqrtrem (const Integer&, Integer&, Integer&);
+
+      /*
+         Each thread keeps the storage of the numbers it frees, to reuse for the next ones.
+         That is given back when the thread ends, or when the thread calls this: say, at the end of a recalc.
+         With GMP, this library sets GMP's memory functions when the program starts: nothing else may.
+      */
+   void releasePooledMemory (void);
 
  } /* namespace BigInt */
 
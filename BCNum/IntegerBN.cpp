@@ -29,7 +29,12 @@ SUCH DAMAGE.
 
 #include "Integer.hpp"
 #include <openssl/bn.h>
+#include <algorithm>
+#include <climits>
+#include <cmath>
 #include <cstring>
+#include <map>
+#include <mutex>
 #include <vector>
 
 namespace BigInt
@@ -65,7 +70,7 @@ namespace BigInt
    public:
       static StaticHolder& getInstance()
        {
-         static StaticHolder instance;
+         static thread_local StaticHolder instance; // The free list and BN_CTX aren't thread safe.
          return instance;
        }
 
@@ -95,6 +100,15 @@ namespace BigInt
           }
        }
 
+      void release()
+       {
+         while (front != back)
+          {
+            BN_free(freeList[front]);
+            front = (front + 1U) & (FREE_LIST_SIZE - 1U);
+          }
+       }
+
       BN_CTX* getCTX()
        {
          if (nullptr == tctx)
@@ -106,15 +120,16 @@ namespace BigInt
 
       ~StaticHolder()
        {
-         while (front != back)
-          {
-            BN_free(freeList[front]);
-            front = (front + 1U) & (FREE_LIST_SIZE - 1U);
-          }
+         release();
          BN_CTX_free(tctx);
        }
     };
 
+   void releasePooledMemory (void)
+    {
+      StaticHolder::getInstance().release();
+    }
+
    class DataHolder final
     {
    public:
@@ -130,12 +145,6 @@ namespace BigInt
          StaticHolder::getInstance().dispose(Data);
        }
 
-      explicit DataHolder (unsigned long src)
-       {
-         Data = StaticHolder::getInstance().getNew();
-         bn_check(BN_set_word(Data, src));
-       }
-
       explicit DataHolder (const char* src)
        {
          Data = StaticHolder::getInstance().getNew();
@@ -147,31 +156,252 @@ namespace BigInt
        }
     };
 
-   Integer::Integer () : Sign (false) { }
+   class SumHolder final
+    {
+   public:
+      BIGNUM* Sum; // Signed, unlike an Integer's Data.
+      BIGNUM* Power; // Ten to the Exponent: the last power used is usually the next one used.
+      BIGNUM* Scaled;
+      unsigned long Exponent;
+
+      SumHolder () : Exponent (0U)
+       {
+         bn_check(Sum = BN_new());
+         bn_check(Power = BN_new());
+         bn_check(Scaled = BN_new());
+         bn_check(BN_one(Power));
+       }
+
+      ~SumHolder ()
+       {
+         BN_free(Sum);
+         BN_free(Power);
+         BN_free(Scaled);
+       }
+
+      void setPower (unsigned long power)
+       {
+         if (power != Exponent)
+          {
+            bn_check(BN_set_word(Scaled, 10U));
+            bn_check(BN_set_word(Power, power));
+            bn_check(BN_exp(Power, Scaled, Power, StaticHolder::getInstance().getCTX()));
+            Exponent = power;
+          }
+       }
+    };
+
+      // A read-only BIGNUM of an Integer's magnitude, wherever it is kept. A Small one is copied into a BIGNUM from the free list.
+   class Magnitude final
+    {
+   private:
+      BIGNUM* temp;
+      const BIGNUM* value;
+
+   public:
+      explicit Magnitude (const Integer& from) : temp (nullptr)
+       {
+         if (nullptr != from.Data.get())
+          {
+            value = from.Data->Data;
+          }
+         else
+          {
+            temp = StaticHolder::getInstance().getNew();
+            if (sizeof(BN_ULONG) >= sizeof(from.Small))
+             {
+               bn_check(BN_set_word(temp, static_cast<BN_ULONG>(from.Small)));
+             }
+            else
+             {
+               bn_check(BN_set_word(temp, static_cast<BN_ULONG>(from.Small >> 32)));
+               bn_check(BN_lshift(temp, temp, 32));
+               bn_check(BN_add_word(temp, static_cast<BN_ULONG>(from.Small & 0xFFFFFFFFU)));
+             }
+            value = temp;
+          }
+       }
+
+      ~Magnitude ()
+       {
+         if (nullptr != temp)
+          {
+            StaticHolder::getInstance().dispose(temp);
+          }
+       }
+
+      Magnitude (const Magnitude&) = delete;
+      Magnitude& operator = (const Magnitude&) = delete;
+
+      const BIGNUM* get (void) const { return value; }
+    };
 
-   Integer::Integer (unsigned long input) : Sign (false)
+      // Does the magnitude of src fit in an unsigned long long? Then put it there.
+   static bool toSmall (const BIGNUM* src, unsigned long long& dest)
     {
-      if (input != 0)
+      if (BN_num_bits(src) > 64) return false;
+      if (sizeof(BN_ULONG) >= sizeof(dest))
        {
-         Data = std::make_shared<DataHolder>((unsigned long)input);
+         dest = BN_get_word(src);
        }
+      else
+       {
+         unsigned char bytes [8];
+         int length = BN_bn2bin(src, bytes);
+         dest = 0U;
+         for (int i = 0; i < length; ++i)
+          {
+            dest = (dest << 8) | bytes[i];
+          }
+       }
+      return true;
+    }
+
+   static const unsigned long long WORD_MAX = static_cast<BN_ULONG>(~static_cast<BN_ULONG>(0U)); // The largest Small that is one BN_ULONG.
+
+      // Multiply two Small magnitudes, if the product fits.
+   static bool multiply (unsigned long long lhs, unsigned long long rhs, unsigned long long& product)
+    {
+#if defined(__GNUC__)
+      return !__builtin_mul_overflow(lhs, rhs, &product);
+#else
+      if (lhs > ULLONG_MAX / rhs) return false;
+      product = lhs * rhs;
+      return true;
+#endif
     }
 
+   Integer::Integer () : Small (0U), Sign (false) { }
+
+   Integer::Integer (unsigned long input) : Small (input), Sign (false) { }
+
    Integer::~Integer ()
     {
       Sign = false;
     }
 
+   void Integer::adopt (const std::shared_ptr<DataHolder>& from)
+    {
+      Sign = (0 != BN_is_negative(from->Data));
+      Small = 0U;
+      Data.reset();
+      if (BN_is_zero(from->Data))
+       {
+         Sign = false;
+         return;
+       }
+
+      if (!toSmall(from->Data, Small))
+       {
+         BN_set_negative(from->Data, 0);
+         Data = from;
+       }
+    }
+
+
+   void Integer::settle (void)
+    {
+      if (BN_is_zero(Data->Data))
+       {
+         Data.reset();
+         Sign = false;
+       }
+      else if (toSmall(Data->Data, Small))
+       {
+         Data.reset();
+       }
+    }
+
+   Integer& Integer::accumulate (const Integer& rhs, bool sign)
+    {
+      if ((nullptr == Data.get()) || (1 != Data.use_count()))
+       {
+         return *this = (sign == rhs.Sign) ? (*this + rhs) : (*this - rhs);
+       }
+      if (rhs.isZero()) return *this;
+
+       {
+         Magnitude right (rhs);
+         if (Sign == sign)
+          {
+            bn_check(BN_add(Data->Data, Data->Data, right.get()));
+          }
+         else
+          {
+            bn_check(BN_sub(Data->Data, Data->Data, right.get()));
+            if (BN_is_negative(Data->Data))
+             {
+               BN_set_negative(Data->Data, 0);
+               Sign = !Sign;
+             }
+          }
+       }
+      settle();
+      return *this;
+    }
+
+   Integer& Integer::addProduct (const Integer& lhs, const Integer& rhs)
+    {
+      if ((nullptr == Data.get()) || (1 != Data.use_count()))
+       {
+         return *this += lhs * rhs;
+       }
+      if (lhs.isZero() || rhs.isZero()) return *this;
+
+      BIGNUM* product = StaticHolder::getInstance().getNew();
+       {
+         Magnitude left (lhs), right (rhs);
+         bn_check(BN_mul(product, left.get(), right.get(), StaticHolder::getInstance().getCTX()));
+       }
+      if (Sign == (lhs.Sign ^ rhs.Sign))
+       {
+         bn_check(BN_add(Data->Data, Data->Data, product));
+       }
+      else
+       {
+         bn_check(BN_sub(Data->Data, Data->Data, product));
+         if (BN_is_negative(Data->Data))
+          {
+            BN_set_negative(Data->Data, 0);
+            Sign = !Sign;
+          }
+       }
+      StaticHolder::getInstance().dispose(product);
+      settle();
+      return *this;
+    }
+
+   Integer& Integer::operator *= (const Integer& rhs)
+    {
+      if ((nullptr == Data.get()) || (1 != Data.use_count()))
+       {
+         return *this = *this * rhs;
+       }
+      if (rhs.isZero()) return *this = Integer();
+
+      if ((nullptr == rhs.Data.get()) && (rhs.Small <= WORD_MAX))
+       {
+         bn_check(BN_mul_word(Data->Data, static_cast<BN_ULONG>(rhs.Small)));
+       }
+      else
+       {
+         Magnitude right (rhs);
+         bn_check(BN_mul(Data->Data, Data->Data, right.get(), StaticHolder::getInstance().getCTX()));
+       }
+      Sign = Sign ^ rhs.Sign; // Still too big for Small: nothing to settle.
+      return *this;
+    }
+
 
 
    bool Integer::isEven (void) const
     {
-      return isZero() ? true : !BN_is_odd(Data->Data);
+      return (nullptr != Data.get()) ? !BN_is_odd(Data->Data) : (0U == (Small & 1U));
     }
 
    bool Integer::is0mod5 (void) const
     {
-      return isZero() ? true : (0 == BN_mod_word(Data->Data, 5U));
+      return (nullptr != Data.get()) ? (0 == BN_mod_word(Data->Data, 5U)) : (0U == (Small % 5U));
     }
 
    Integer& Integer::negate (void)
@@ -189,9 +419,8 @@ namespace BigInt
 
    long Integer::toInt (void) const //It works for its purpose.
     {
-      if (isZero()) return 0;
-      if (~0UL == BN_get_word(Data->Data)) return 0;
-      return Sign ? -BN_get_word(Data->Data) : BN_get_word(Data->Data);
+      if ((nullptr != Data.get()) || (Small > static_cast<unsigned long long>(INT_MAX))) return 0;
+      return Sign ? -static_cast<long>(Small) : static_cast<long>(Small);
     }
 
 
@@ -217,30 +446,28 @@ namespace BigInt
        }
 
        /*
-         Test for zeros, which are always positive.
+         Compare the magnitudes. Anything in Data is bigger than anything in Small.
        */
-      if (!Sign)
+      int result;
+      if (nullptr != Data.get())
        {
-         if (isZero())
-          {
-             // Both are Zero.
-            if (to.isZero()) return 0;
-             // I'm Zero, he isn't.
-            return -1;
-         }
-        if (to.isZero())
-         {
-            // I'm not zero.
-            return 1;
-         }
+         result = (nullptr != to.Data.get()) ? BN_cmp(Data->Data, to.Data->Data) : 1;
+       }
+      else if (nullptr != to.Data.get())
+       {
+         result = -1;
+       }
+      else
+       {
+         result = (Small < to.Small) ? -1 : ((Small > to.Small) ? 1 : 0);
        }
 
        /*
          Return the unsigned comparison, remembering that if we are
          negative, then the result is negated.
        */
-      if (Sign) return -BN_cmp(Data->Data, to.Data->Data);
-      return BN_cmp(Data->Data, to.Data->Data);
+      if (Sign) return -result;
+      return result;
     }
 
 
@@ -258,133 +485,274 @@ namespace BigInt
          return rhs;
        }
 
-      result.Sign = lhs.Sign;
-      result.Data = std::make_shared<DataHolder>();
-
-      if (lhs.Sign == rhs.Sign) bn_check(BN_add(result.Data->Data, lhs.Data->Data, rhs.Data->Data));
-      else bn_check(BN_sub(result.Data->Data, lhs.Data->Data, rhs.Data->Data));
-
-      int sign = -BN_is_negative(result.Data->Data);
-      sign |= BN_is_zero(result.Data->Data);
-      switch (sign)
+      if ((nullptr == lhs.Data.get()) && (nullptr == rhs.Data.get()))
        {
-         case -1:
-            result.Sign = !result.Sign;
-            BN_set_negative(result.Data->Data, 0);
-            break;
+         if (lhs.Sign != rhs.Sign)
+          {
+            if (lhs.Small >= rhs.Small)
+             {
+               result.Small = lhs.Small - rhs.Small;
+               result.Sign = (0U != result.Small) && lhs.Sign;
+             }
+            else
+             {
+               result.Small = rhs.Small - lhs.Small;
+               result.Sign = rhs.Sign;
+             }
+            return result;
+          }
+         if (lhs.Small <= ULLONG_MAX - rhs.Small)
+          {
+            result.Small = lhs.Small + rhs.Small;
+            result.Sign = lhs.Sign;
+            return result;
+          }
+       }
 
-         case 1:
-            result.Sign = false;
-            result.Data.reset();
-            break;
+      std::shared_ptr<DataHolder> sum = std::make_shared<DataHolder>();
 
-         default:
-            break;
+       {
+         Magnitude left (lhs), right (rhs);
+         if (lhs.Sign == rhs.Sign) bn_check(BN_add(sum->Data, left.get(), right.get()));
+         else bn_check(BN_sub(sum->Data, left.get(), right.get()));
        }
+      if (lhs.Sign) BN_set_negative(sum->Data, !BN_is_negative(sum->Data));
 
+      result.adopt(sum);
       return result;
     }
 
    Integer operator - (const Integer& lhs, const Integer& rhs)
+    {
+      return lhs + -rhs;
+    }
+
+   Integer operator * (const Integer& lhs, const Integer& rhs)
     {
       Integer result;
 
-      if (rhs.isZero())
+      if (lhs.isZero() || rhs.isZero())
        {
-         return lhs;
+         return result;
        }
-      if (lhs.isZero())
+
+      if ((nullptr == lhs.Data.get()) && (nullptr == rhs.Data.get()))
        {
-         return -rhs;
+         if (multiply(lhs.Small, rhs.Small, result.Small))
+          {
+            result.Sign = lhs.Sign ^ rhs.Sign;
+            return result;
+          }
        }
 
-      result.Sign = lhs.Sign;
-      result.Data = std::make_shared<DataHolder>();
-
-      if (lhs.Sign == rhs.Sign) bn_check(BN_sub(result.Data->Data, lhs.Data->Data, rhs.Data->Data));
-      else bn_check(BN_add(result.Data->Data, lhs.Data->Data, rhs.Data->Data));
+      std::shared_ptr<DataHolder> product = std::make_shared<DataHolder>();
 
-      int sign = -BN_is_negative(result.Data->Data);
-      sign |= BN_is_zero(result.Data->Data);
-      switch (sign)
        {
-         case -1:
-            result.Sign = !result.Sign;
-            BN_set_negative(result.Data->Data, 0);
-            break;
-
-         case 1:
-            result.Sign = false;
-            result.Data.reset();
-            break;
+         Magnitude left (lhs), right (rhs);
 
-         default:
-            break;
+            // A factor that fits in one word, like a power of ten when rescaling, uses the single-word multiply.
+         if ((nullptr == rhs.Data.get()) && (rhs.Small <= WORD_MAX))
+          {
+            bn_check(BN_copy(product->Data, left.get()));
+            bn_check(BN_mul_word(product->Data, static_cast<BN_ULONG>(rhs.Small)));
+          }
+         else if ((nullptr == lhs.Data.get()) && (lhs.Small <= WORD_MAX))
+          {
+            bn_check(BN_copy(product->Data, right.get()));
+            bn_check(BN_mul_word(product->Data, static_cast<BN_ULONG>(lhs.Small)));
+          }
+         else
+          {
+            bn_check(BN_mul(product->Data, left.get(), right.get(), StaticHolder::getInstance().getCTX()));
+          }
        }
 
+      result.adopt(product);
+      result.Sign = lhs.Sign ^ rhs.Sign;
       return result;
     }
 
-   Integer operator * (const Integer& lhs, const Integer& rhs)
+
+
+   void Integer::fromString (const std::string& src)
     {
-      Integer result;
+      fromString(src.c_str());
+    }
 
-      if (lhs.isZero() || rhs.isZero())
+   void Integer::fromString (const char* src)
+    {
+         // Plain digits are read in place. Anything else is left to OpenSSL.
+      const char* digits = ('-' == *src) ? src + 1 : src;
+      size_t length = std::strlen(digits);
+      if ((0U != length) && (length == std::strspn(digits, "0123456789")))
        {
-         return result;
+         fromDigits(digits, length);
+         if (digits != src) negate();
+         return;
        }
 
-      result.Data = std::make_shared<DataHolder>();
-      bn_check(BN_mul(result.Data->Data, lhs.Data->Data, rhs.Data->Data, StaticHolder::getInstance().getCTX()));
-      result.Sign = lhs.Sign ^ rhs.Sign;
-
-      return result;
+      adopt(std::make_shared<DataHolder>(src));
     }
 
 
 
-   void Integer::fromString (const std::string& src)
+   static const size_t WORD_DIGITS = (WORD_MAX > 0xFFFFFFFFU) ? 19U : 9U; // The most digits that always fit in a BN_ULONG.
+   static const BN_ULONG WORD_POWER = static_cast<BN_ULONG>((WORD_MAX > 0xFFFFFFFFU) ? 10000000000000000000ULL : 1000000000ULL);
+   static const size_t HORNER_DIGITS = 1000U; // Up to this many, read a word at a time. Past it, split the digits in halves.
+
+      // The digits of a number, maybe split in two around a decimal point.
+   class DigitRun final
     {
-      fromString(src.c_str());
+   public:
+      const char* first;
+      size_t firstLength;
+      const char* second;
+
+      char operator [] (size_t index) const { return (index < firstLength) ? first[index] : second[index - firstLength]; }
+
+      BN_ULONG word (size_t begin, size_t length) const
+       {
+         BN_ULONG result = 0U;
+         for (size_t i = begin; i < begin + length; ++i)
+          {
+            result = result * 10U + static_cast<BN_ULONG>((*this)[i] - '0');
+          }
+         return result;
+       }
+    };
+
+   static void readShort (BIGNUM* result, const DigitRun& digits, size_t begin, size_t length)
+    {
+      size_t head = length % WORD_DIGITS; // Read the odd digits first, so that the rest are whole words.
+      if (0U == head) head = WORD_DIGITS;
+      bn_check(BN_set_word(result, digits.word(begin, head)));
+      for (size_t i = begin + head; i < begin + length; i += WORD_DIGITS)
+       {
+         bn_check(BN_mul_word(result, WORD_POWER));
+         bn_check(BN_add_word(result, digits.word(i, WORD_DIGITS)));
+       }
     }
 
-   void Integer::fromString (const char* src)
+      // The length is at most HORNER_DIGITS << level, and powers[j] is ten to the (HORNER_DIGITS << j).
+   static void readLong (BIGNUM* result, const DigitRun& digits, size_t begin, size_t length,
+                         const std::vector<std::unique_ptr<DataHolder> >& powers, size_t level)
+    {
+      if (0U == level)
+       {
+         readShort(result, digits, begin, length);
+         return;
+       }
+      const size_t half = HORNER_DIGITS << (level - 1U);
+      if (length <= half)
+       {
+         readLong(result, digits, begin, length, powers, level - 1U);
+         return;
+       }
+      DataHolder low;
+      readLong(result, digits, begin, length - half, powers, level - 1U);
+      readLong(low.Data, digits, begin + length - half, half, powers, level - 1U);
+      bn_check(BN_mul(result, result, powers[level - 1U]->Data, StaticHolder::getInstance().getCTX()));
+      bn_check(BN_add(result, result, low.Data));
+    }
+
+   void Integer::fromDigits (const char* first, size_t firstLength, const char* second, size_t secondLength)
     {
       Sign = false;
-      Data = std::make_shared<DataHolder>(src);
+      Small = 0U;
+      Data.reset();
 
-      int sign = -BN_is_negative(Data->Data);
-      sign |= BN_is_zero(Data->Data);
-      switch (sign)
-       {
-         case -1:
-            Sign = true;
-            BN_set_negative(Data->Data, 0);
-            break;
+      const DigitRun digits { first, firstLength, second };
+      const size_t length = firstLength + secondLength;
+      size_t begin = 0U;
+      while ((begin < length) && ('0' == digits[begin])) ++begin;
 
-         case 1:
-            Data.reset();
-            break;
+      if (length - begin <= 19U)
+       {
+         for (size_t i = begin; i < length; ++i)
+          {
+            Small = Small * 10U + static_cast<unsigned long long>(digits[i] - '0');
+          }
+         return;
+       }
 
-         default:
-            break;
+      std::vector<std::unique_ptr<DataHolder> > powers;
+      size_t level = 0U;
+      while ((HORNER_DIGITS << level) < length - begin)
+       {
+         powers.emplace_back(new DataHolder());
+         if (0U == level)
+          {
+            bn_check(BN_copy(powers.back()->Data, pow10(HORNER_DIGITS).Data->Data));
+          }
+         else
+          {
+            bn_check(BN_sqr(powers.back()->Data, powers[level - 1U]->Data, StaticHolder::getInstance().getCTX()));
+          }
+         ++level;
        }
+
+      std::shared_ptr<DataHolder> result = std::make_shared<DataHolder>();
+      readLong(result->Data, digits, begin, length - begin, powers, level);
+      adopt(result);
     }
 
 
 
-   std::string Integer::toString () const
+   static size_t smallDigits (unsigned long long value, char* buffer)
     {
-      std::string result;
+      char reversed [20];
+      size_t length = 0U;
+      do
+       {
+         reversed[length++] = static_cast<char>('0' + value % 10U);
+         value /= 10U;
+       }
+      while (0U != value);
+      for (size_t i = 0U; i < length; ++i)
+       {
+         buffer[i] = reversed[length - 1U - i];
+       }
+      buffer[length] = '\0';
+      return length;
+    }
+
+   size_t Integer::maxDigits (void) const
+    {
+      if (nullptr == Data.get()) return 20U; // The digits in ULLONG_MAX
+         // 1234 / 4096 is just over log10(2), so this may count a few digits too many, but never too few.
+      return ((static_cast<size_t>(BN_num_bits(Data->Data)) * 1234U) >> 12) + 1U;
+    }
 
-      if (isZero()) return std::string("0");
-      if (isSigned()) result = "-";
+   size_t Integer::toDigits (char * buffer) const
+    {
+      if (nullptr == Data.get()) return smallDigits(Small, buffer);
 
+         // OpenSSL can't write into our buffer, so this costs one copy.
       char * rstring = BN_bn2dec(Data->Data);
       bn_check(rstring);
-      result += rstring;
+      const size_t length = std::strlen(rstring);
+      std::memcpy(buffer, rstring, length + 1U);
       OPENSSL_free(rstring);
 
+      return length;
+    }
+
+   std::string Integer::toString () const
+    {
+      const size_t sign = isSigned() ? 1U : 0U;
+      std::string result (sign + maxDigits() + 1U, '-');
+
+      result.resize(sign + toDigits(&result[sign]));
+
+      return result;
+    }
+
+   std::string Integer::leadingDigits (size_t count, size_t& total) const
+    {
+         // OpenSSL has no cheap way to get just the leading digits, so convert it all.
+      std::string result (maxDigits() + 1U, '\0');
+      total = toDigits(&result[0]);
+      result.resize(std::min(total, count));
       return result;
     }
 
@@ -409,52 +777,396 @@ namespace BigInt
       bool
          qSign = lhs.isSigned() ^ rhs.isSigned(),
          rSign = lhs.isSigned();
+
+      if ((nullptr == lhs.Data.get()) && (nullptr == rhs.Data.get()))
+       {
+         unsigned long long
+            quot = lhs.Small / rhs.Small,
+            rem = lhs.Small % rhs.Small;
+
+         q = Integer();
+         r = Integer();
+
+         q.Small = quot;
+         q.Sign = (0U != quot) && qSign;
+         r.Small = rem;
+         r.Sign = (0U != rem) && rSign;
+         return;
+       }
+
       std::shared_ptr<DataHolder> quot, rem;
 
       quot = std::make_shared<DataHolder>();
+
+         // A divisor that fits in one word, like a power of ten when rescaling, uses the single-word divide.
+      if ((nullptr == rhs.Data.get()) && (rhs.Small <= WORD_MAX))
+       {
+         bn_check(BN_copy(quot->Data, lhs.Data->Data));
+         BN_ULONG word = BN_div_word(quot->Data, static_cast<BN_ULONG>(rhs.Small));
+
+         q = Integer();
+         r = Integer();
+
+         q.adopt(quot);
+         q.Sign = !q.isZero() && qSign;
+         r.Small = word;
+         r.Sign = (0U != word) && rSign;
+         return;
+       }
+
       rem = std::make_shared<DataHolder>();
 
-      bn_check(BN_div(quot->Data, rem->Data, lhs.Data->Data, rhs.Data->Data, StaticHolder::getInstance().getCTX()));
+       {
+         Magnitude left (lhs), right (rhs);
+         bn_check(BN_div(quot->Data, rem->Data, left.get(), right.get(), StaticHolder::getInstance().getCTX()));
+       }
 
       q = Integer();
       r = Integer();
 
-      int sign = BN_is_zero(quot->Data);
-      if (1 != sign)
+      q.adopt(quot);
+      q.Sign = !q.isZero() && qSign;
+      r.adopt(rem);
+      r.Sign = !r.isZero() && rSign;
+    }
+
+
+
+      // The square root of the double is within a few of the integer one: the loops make it exact.
+   static unsigned long long smallSqrt (unsigned long long radicand)
+    {
+      static const unsigned long long LARGEST_ROOT = 0xFFFFFFFFULL;
+      unsigned long long root = static_cast<unsigned long long>(std::sqrt(static_cast<double>(radicand)));
+      if (root > LARGEST_ROOT)
+         root = LARGEST_ROOT;
+      while (root * root > radicand)
+         --root;
+      while ((root < LARGEST_ROOT) && ((root + 1U) * (root + 1U) <= radicand))
+         ++root;
+      return root;
+    }
+
+   void sqrtrem (const Integer& radicand, Integer& root, Integer& rem)
+    {
+      if (nullptr == radicand.Data.get())
        {
-         q.Data = quot;
-         q.Sign = qSign;
+         unsigned long long
+            s = smallSqrt(radicand.Small),
+            left = radicand.Small - s * s;
+
+         root = Integer();
+         rem = Integer();
+
+         root.Small = s;
+         rem.Small = left;
+         return;
        }
 
-      sign = BN_is_zero(rem->Data);
-      if (1 != sign)
+      std::shared_ptr<DataHolder> whole, left;
+
+      whole = std::make_shared<DataHolder>();
+      left = std::make_shared<DataHolder>();
+
        {
-         r.Data = rem;
-         r.Sign = rSign;
+            // OpenSSL has no integer square root, so use Newton's method. Starting above the root,
+            // it comes down to it without overshooting, and stops as soon as it stops going down.
+         StaticHolder& holder = StaticHolder::getInstance();
+         Magnitude from (radicand);
+         BIGNUM* next = holder.getNew();
+         bn_check(BN_set_word(whole->Data, 1U));
+         bn_check(BN_lshift(whole->Data, whole->Data, (BN_num_bits(from.get()) + 1) / 2));
+         for (;;)
+          {
+            bn_check(BN_div(next, nullptr, from.get(), whole->Data, holder.getCTX()));
+            bn_check(BN_add(next, next, whole->Data));
+            bn_check(BN_rshift1(next, next));
+            if (BN_cmp(next, whole->Data) >= 0)
+               break;
+            BN_swap(next, whole->Data);
+          }
+         bn_check(BN_sqr(next, whole->Data, holder.getCTX()));
+         bn_check(BN_sub(left->Data, from.get(), next));
+         holder.dispose(next);
        }
+
+      root = Integer();
+      rem = Integer();
+
+      root.adopt(whole);
+      rem.adopt(left);
     }
 
 
-   static BIGNUM *s_ten = nullptr, *s_power = nullptr;
-   Integer pow10 (unsigned long power)
+
+   static const int RECIPROCAL_BITS = 64 * BN_BITS2; // For a smaller divisor, BN_div is faster.
+
+   class DivisorHolder final
+    {
+   public:
+      BN_RECP_CTX* Reciprocal;
+
+      DivisorHolder ()
+       {
+         bn_check(Reciprocal = BN_RECP_CTX_new());
+       }
+
+      ~DivisorHolder ()
+       {
+         BN_RECP_CTX_free(Reciprocal);
+       }
+
+      DivisorHolder (const DivisorHolder&) = delete;
+      DivisorHolder& operator = (const DivisorHolder&) = delete;
+    };
+
+   Integer_Divisor::Integer_Divisor (const Integer& divisor) : Divisor (divisor), Data (), Uses (0U) { }
+
+   Integer_Divisor::~Integer_Divisor () { }
+
+   void Integer_Divisor::reset (const Integer& divisor)
+    {
+      Divisor = divisor;
+      Data.reset();
+      Uses = 0U;
+    }
+
+   void Integer_Divisor::quotrem (const Integer& dividend, Integer& quotient, Integer& remainder)
+    {
+      if ((nullptr == Divisor.Data.get()) || (BN_num_bits(Divisor.Data->Data) < RECIPROCAL_BITS) ||
+         (nullptr == dividend.Data.get()) || (1U == ++Uses))
+       {
+         BigInt::quotrem(dividend, Divisor, quotient, remainder);
+         return;
+       }
+
+      BN_CTX* ctx = StaticHolder::getInstance().getCTX();
+      if (nullptr == Data.get())
+       {
+         Data.reset(new DivisorHolder());
+         bn_check(BN_RECP_CTX_set(Data->Reciprocal, Divisor.Data->Data, ctx));
+       }
+
+      const bool qSign = dividend.Sign ^ Divisor.Sign, rSign = dividend.Sign;
+      std::shared_ptr<DataHolder> quot = std::make_shared<DataHolder>(), rem = std::make_shared<DataHolder>();
+      bn_check(BN_div_recp(quot->Data, rem->Data, dividend.Data->Data, Data->Reciprocal, ctx));
+
+      quotient = Integer();
+      remainder = Integer();
+
+      quotient.adopt(quot);
+      quotient.Sign = !quotient.isZero() && qSign;
+      remainder.adopt(rem);
+      remainder.Sign = !remainder.isZero() && rSign;
+    }
+
+
+   Integer_Accumulator::Integer_Accumulator () : Data (new SumHolder()) { }
+
+   Integer_Accumulator::~Integer_Accumulator () { }
+
+   void Integer_Accumulator::add (const Integer& addend, unsigned long power)
+    {
+      if (addend.isZero()) return;
+
+      Magnitude magnitude (addend);
+      const BIGNUM* value = magnitude.get();
+      if (0U != power)
+       {
+         Data->setPower(power);
+         bn_check(BN_mul(Data->Scaled, value, Data->Power, StaticHolder::getInstance().getCTX()));
+         value = Data->Scaled;
+       }
+
+      if (addend.Sign) bn_check(BN_sub(Data->Sum, Data->Sum, value));
+      else bn_check(BN_add(Data->Sum, Data->Sum, value));
+    }
+
+   void Integer_Accumulator::addProduct (const Integer& lhs, const Integer& rhs, unsigned long power)
+    {
+      if (lhs.isZero() || rhs.isZero()) return;
+
+      if (0U != power) Data->setPower(power); // First: this uses Scaled.
+       {
+         Magnitude left (lhs), right (rhs);
+         bn_check(BN_mul(Data->Scaled, left.get(), right.get(), StaticHolder::getInstance().getCTX()));
+       }
+      if (0U != power)
+       {
+         bn_check(BN_mul(Data->Scaled, Data->Scaled, Data->Power, StaticHolder::getInstance().getCTX()));
+       }
+
+      if (lhs.Sign ^ rhs.Sign) bn_check(BN_sub(Data->Sum, Data->Sum, Data->Scaled));
+      else bn_check(BN_add(Data->Sum, Data->Sum, Data->Scaled));
+    }
+
+   void Integer_Accumulator::scale (unsigned long power)
+    {
+      if (0U == power) return;
+
+      Data->setPower(power);
+      bn_check(BN_mul(Data->Sum, Data->Sum, Data->Power, StaticHolder::getInstance().getCTX()));
+    }
+
+   Integer Integer_Accumulator::get (void) const
     {
       Integer result;
 
-      if (0U == power) return Integer(1U);
+      if (!BN_is_zero(Data->Sum))
+       {
+         if (!toSmall(Data->Sum, result.Small))
+          {
+            result.Data = std::make_shared<DataHolder>();
+            bn_check(BN_copy(result.Data->Data, Data->Sum));
+            BN_set_negative(result.Data->Data, 0);
+          }
+         result.Sign = (0 != BN_is_negative(Data->Sum));
+       }
+
+      return result;
+    }
+
+
 
-      if (nullptr == s_ten)
+   static const unsigned long long SMALL_POWERS [20] = // Every power of ten that fits in an unsigned long long.
+    {
+      1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+      10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+      1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+    };
+
+   static const unsigned long CACHED_POWER = 4096U; // Larger powers are made each time they are needed, and not kept.
+   static const size_t CACHED_COUNT = 64U; // The most powers kept: past this, the one used longest ago is dropped.
+
+      // Powers of ten that are shared by every thread.
+      // The lock is only held to look in the cache: a power is computed outside of it.
+   class PowerCache final
+    {
+   private:
+      class Entry final
+       {
+      public:
+         Integer value;
+         unsigned long long lastUsed;
+       };
+
+      std::mutex lock;
+      std::map<unsigned long, Entry> entries;
+      unsigned long long clock;
+
+   public:
+      PowerCache() : clock(0U) { }
+
+      bool find (unsigned long power, Integer& result)
+       {
+         std::lock_guard<std::mutex> guard (lock);
+         std::map<unsigned long, Entry>::iterator found = entries.find(power);
+         if (entries.end() == found) return false;
+         found->second.lastUsed = ++clock;
+         result = found->second.value;
+         return true;
+       }
+
+      void insert (unsigned long power, const Integer& value)
+       {
+         std::lock_guard<std::mutex> guard (lock);
+         if (entries.end() != entries.find(power)) return; // Another thread made it first.
+         if (entries.size() >= CACHED_COUNT)
+          {
+            std::map<unsigned long, Entry>::iterator oldest = entries.begin();
+            for (std::map<unsigned long, Entry>::iterator iter = entries.begin(); entries.end() != iter; ++iter)
+             {
+               if (iter->second.lastUsed < oldest->second.lastUsed) oldest = iter;
+             }
+            entries.erase(oldest);
+          }
+         Entry& entry = entries[power];
+         entry.value = value;
+         entry.lastUsed = ++clock;
+       }
+    };
+
+   Integer pow10 (unsigned long power)
+    {
+      Integer result;
+
+      if (power < sizeof(SMALL_POWERS) / sizeof(SMALL_POWERS[0]))
        {
-         bn_check(s_ten = BN_new());
-         bn_check(BN_set_word(s_ten, 10U));
-         bn_check(s_power = BN_new());
+         result.Small = SMALL_POWERS[power];
+         return result;
        }
 
-      bn_check(BN_set_word(s_power, power));
-      result.Data = std::make_shared<DataHolder>();
+         // The cache is never freed, so that it outlives anything that uses it while the program exits.
+      static PowerCache* cache = new PowerCache();
+      const bool kept = (power <= CACHED_POWER);
+      if ((true == kept) && (true == cache->find(power, result)))
+       {
+         return result;
+       }
 
-      bn_check(BN_exp(result.Data->Data, s_ten, s_power, StaticHolder::getInstance().getCTX()));
+      std::shared_ptr<DataHolder> value = std::make_shared<DataHolder>();
+      BIGNUM* ten = StaticHolder::getInstance().getNew();
+      BIGNUM* exponent = StaticHolder::getInstance().getNew();
+      bn_check(BN_set_word(ten, 10U));
+      bn_check(BN_set_word(exponent, power));
+      bn_check(BN_exp(value->Data, ten, exponent, StaticHolder::getInstance().getCTX()));
+      StaticHolder::getInstance().dispose(ten);
+      StaticHolder::getInstance().dispose(exponent);
+      result.adopt(value);
+      if (true == kept) cache->insert(power, result);
 
       return result;
     }
 
+
+   static const double LOG2_10 = 3.321928094887362; // Bits in a decimal digit
+
+   int Integer::compareScaled (const Integer& to, unsigned long power) const
+    {
+      const int lhsSign = isZero() ? 0 : (Sign ? -1 : 1);
+      const int rhsSign = to.isZero() ? 0 : (to.Sign ? -1 : 1);
+      if (lhsSign != rhsSign) return (lhsSign < rhsSign) ? -1 : 1;
+      if ((0 == lhsSign) || (0U == power)) return compare(to);
+
+       /*
+         Both have the same sign: compare the magnitudes, and flip the answer if they are negative.
+       */
+      int result;
+      unsigned long long product;
+      if ((nullptr == Data.get()) && (nullptr == to.Data.get()) && (power < sizeof(SMALL_POWERS) / sizeof(SMALL_POWERS[0])))
+       {
+         if (multiply(to.Small, SMALL_POWERS[power], product))
+            result = (Small < product) ? -1 : ((Small > product) ? 1 : 0);
+         else
+            result = -1;
+       }
+      else
+       {
+         Magnitude lhs (*this), rhs (to);
+            // The lhs is in [2^(lhsBits - 1), 2^lhsBits), and the scaled rhs in [2^(rhsBits - 1 + power * LOG2_10), 2^(rhsBits + power * LOG2_10)).
+         const unsigned long long lhsBits = BN_num_bits(lhs.get()), rhsBits = BN_num_bits(rhs.get());
+         const unsigned long long scaleLow = static_cast<unsigned long long>(power * LOG2_10) - 1U; // Give or take rounding
+         const unsigned long long scaleHigh = static_cast<unsigned long long>(power * LOG2_10) + 2U;
+         if (lhsBits + 1U <= rhsBits + scaleLow)
+          {
+            result = -1;
+          }
+         else if (lhsBits >= rhsBits + scaleHigh + 1U)
+          {
+            result = 1;
+          }
+         else
+          {
+               // Too close to call: scale the rhs into a number from the free list.
+            StaticHolder& holder = StaticHolder::getInstance();
+            BIGNUM* scratch = holder.getNew();
+            Integer scale = pow10(power);
+            Magnitude by (scale);
+            bn_check(BN_mul(scratch, rhs.get(), by.get(), holder.getCTX()));
+            result = BN_ucmp(lhs.get(), scratch);
+            holder.dispose(scratch);
+          }
+       }
+      return Sign ? -result : result;
+    }
+
  } /* namespace BigInt */
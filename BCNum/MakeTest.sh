@@ -24,7 +24,7 @@ if [ "$1" == "clean" ]; then
 fi
 
 g++ -c -Wall -Wextra -Wpedantic -g --coverage -O0 Fixed.cpp Integer.cpp
-g++ -o Test -Wall -Wextra -Wpedantic -g --coverage -O0 -I../../External/googletest/include Test.cpp Fixed.o Integer.o ../../External/googletest/lib/libgtest.a ../../External/googletest/lib/libgtest_main.a -lgmp
+g++ -o Test -Wall -Wextra -Wpedantic -g --coverage -O0 -I../../External/googletest/include Test.cpp Fixed.o Integer.o ../../External/googletest/lib/libgtest.a ../../External/googletest/lib/libgtest_main.a -lgmp -lpthread
 
 
 if [ "$1" == "nocov" ]; then
@@ -33,6 +33,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "Fixed.hpp"
 
+#include <thread>
+#include <vector>
+
    // Basically, making this legacy code no longer legacy by creating tests.
    // Run IO through its paces, so that we can use it as a root of trust for further tests.
 TEST(FixedTests, testNoBadBoom)
@@ -1086,6 +1089,36 @@ TEST(FixedTests, testNewRoundMode)
 
  }
 
+TEST(FixedTests, testContexts)
+ {
+   BigInt::Fixed a ("1");
+   BigInt::Fixed b ("3");
+   BigInt::Fixed c;
+
+   c = BigInt::Fixed::divide(a, b, BigInt::Fixed_Context(5U, BigInt::ROUND_AWAY));
+   EXPECT_EQ("0.33334", c.toString());
+   c = BigInt::Fixed::multiply(BigInt::Fixed("0.25"), BigInt::Fixed("0.5"), BigInt::Fixed_Context(0U, BigInt::ROUND_AWAY));
+   EXPECT_EQ("0.13", c.toString());
+   EXPECT_EQ(0U, BigInt::Fixed::getDefaultPrecision());
+   EXPECT_EQ(BigInt::ROUND_TIES_EVEN, BigInt::Fixed::getRoundMode());
+
+    {
+      BigInt::Fixed_Context_Holder hold (BigInt::Fixed_Context(3U, BigInt::ROUND_ZERO));
+      c = a - a / b;
+      EXPECT_EQ("0.667", c.toString());
+      BigInt::Fixed::setDefaultPrecision(4U);
+    }
+   EXPECT_EQ(BigInt::Fixed_Context(), BigInt::Fixed::getContext());
+
+      // Another thread's context is its own.
+   BigInt::Fixed::setDefaultPrecision(2U);
+   std::thread other ([&c, &a, &b] () { BigInt::Fixed::setDefaultPrecision(7U); c = a / b; });
+   other.join();
+   EXPECT_EQ("0.3333333", c.toString());
+   EXPECT_EQ(2U, BigInt::Fixed::getDefaultPrecision());
+   BigInt::Fixed::setDefaultPrecision(0U);
+ }
+
 TEST(FixedTests, testNowImpossible)
  {
    BigInt::Integer three (3UL);
@@ -1265,3 +1298,599 @@ TEST(FixedTests, testNewMathCases)
    r = z / z;
    EXPECT_TRUE(r.isNaN());
  }
+
+TEST(FixedTests, testAccumulator)
+ {
+   const char* const addends [] = { "1.5", "-2", "0.125", "-0.125", "1000000000000000000000", "-3.75", "0", "0.00", "7.1" };
+
+      // Any order, and any prefix, gives what the left fold does: value and scale.
+   for (size_t first = 0U; first < sizeof(addends) / sizeof(addends[0]); ++first)
+    {
+      BigInt::Fixed fold ("0");
+      BigInt::Fixed_Accumulator sum;
+      for (size_t i = 0U; i < sizeof(addends) / sizeof(addends[0]); ++i)
+       {
+         BigInt::Fixed addend (addends[(first + i) % (sizeof(addends) / sizeof(addends[0]))]);
+         fold = fold + addend;
+         sum += addend;
+         BigInt::Fixed got = sum.get();
+         EXPECT_EQ(fold.toString(), got.toString());
+         EXPECT_EQ(fold.getPrecision(), got.getPrecision());
+         EXPECT_EQ(fold.isSigned(), got.isSigned());
+       }
+    }
+
+   BigInt::Fixed_Accumulator zero;
+   EXPECT_TRUE(zero.get().isZero());
+   EXPECT_EQ(0U, zero.get().getPrecision());
+
+   BigInt::Fixed_Accumulator scaled (3U);
+   scaled += BigInt::Fixed("1.5");
+   EXPECT_EQ("1.500", scaled.get().toString());
+
+   BigInt::Fixed_Accumulator cancels;
+   cancels += BigInt::Fixed("2.5");
+   cancels += BigInt::Fixed("-2.5");
+   EXPECT_TRUE(cancels.get().isZero());
+   EXPECT_FALSE(cancels.get().isSigned());
+   EXPECT_EQ(1U, cancels.get().getPrecision());
+
+      // NaN and Infinity, as operator + has them.
+   const BigInt::Fixed n (false, true), i (true, false), a ("1");
+   BigInt::Fixed_Accumulator inf;
+   inf += a;
+   inf += i;
+   EXPECT_TRUE(inf.get().isInf());
+   inf += a;
+   EXPECT_TRUE(inf.get().isInf());
+   inf += i;
+   EXPECT_TRUE(inf.get().isNaN());
+
+   BigInt::Fixed_Accumulator nan;
+   nan += n;
+   nan += i;
+   EXPECT_TRUE(nan.get().isNaN());
+
+   BigInt::Fixed_Accumulator infNan;
+   infNan += i;
+   infNan += n;
+   EXPECT_TRUE(infNan.get().isNaN());
+ }
+
+TEST(FixedTests, testSmallIntegers)
+ {
+   const std::string max = "18446744073709551615", over = "18446744073709551616"; // 2^64 - 1 and 2^64
+   BigInt::Integer small, big, one (1U), q, r;
+   small.fromString(max);
+   big.fromString(over);
+
+      // Crossing out of a machine word and back again.
+   EXPECT_EQ(over, (small + one).toString());
+   EXPECT_EQ(max, (big - one).toString());
+   EXPECT_EQ("-" + over, (-small - one).toString());
+   EXPECT_EQ("1", (big - small).toString());
+   EXPECT_EQ("-1", (small - big).toString());
+   EXPECT_TRUE((big - big).isZero());
+   EXPECT_FALSE((big - big).isSigned());
+   EXPECT_EQ("36893488147419103230", (small * BigInt::Integer(2U)).toString());
+   EXPECT_EQ("-340282366920938463426481119284349108225", (small * -small).toString());
+
+   BigInt::Integer word;
+   word.fromString("4294967296");
+   EXPECT_EQ(0, (word * word).compare(big));
+
+   EXPECT_EQ(1, big.compare(small));
+   EXPECT_EQ(-1, small.compare(big));
+   EXPECT_EQ(1, (-small).compare(-big));
+   EXPECT_EQ(-1, (-big).compare(small));
+
+   quotrem(big, BigInt::Integer(3U), q, r);
+   EXPECT_EQ("6148914691236517205", q.toString());
+   EXPECT_EQ("1", r.toString());
+   quotrem(-big, small, q, r);
+   EXPECT_EQ("-1", q.toString());
+   EXPECT_EQ("-1", r.toString());
+   quotrem(small, big, q, r);
+   EXPECT_TRUE(q.isZero());
+   EXPECT_FALSE(q.isSigned());
+   EXPECT_EQ(max, r.toString());
+   quotrem(BigInt::Integer(7U), -BigInt::Integer(2U), q, r);
+   EXPECT_EQ("-3", q.toString());
+   EXPECT_EQ("1", r.toString());
+
+   EXPECT_EQ("10000000000000000000", BigInt::pow10(19U).toString());
+   EXPECT_EQ("100000000000000000000", BigInt::pow10(20U).toString());
+   EXPECT_EQ(0, (BigInt::pow10(19U) * BigInt::Integer(10U)).compare(BigInt::pow10(20U)));
+
+   EXPECT_TRUE(big.isEven());
+   EXPECT_FALSE(small.is0mod5() == big.is0mod5());
+   EXPECT_EQ(0, big.toInt());
+
+   BigInt::Integer negativeZero;
+   negativeZero.fromString("-0");
+   EXPECT_TRUE(negativeZero.isZero());
+   EXPECT_FALSE(negativeZero.isSigned());
+   negativeZero.fromString("-2147483647");
+   EXPECT_EQ(-2147483647L, negativeZero.toInt());
+ }
+
+TEST(FixedTests, testPowersOfTen)
+ {
+   std::string expected = "1";
+   for (unsigned long power = 0U; power < 64U; ++power)
+    {
+      EXPECT_EQ(expected, BigInt::pow10(power).toString());
+      EXPECT_EQ(expected, BigInt::pow10(power).toString()); // Again, from the cache.
+      expected += "0";
+    }
+
+      // Only so many are kept, and huge ones aren't kept at all: they still come out right.
+   for (unsigned long power = 200U; power < 400U; ++power)
+    {
+      EXPECT_EQ(power + 1U, BigInt::pow10(power).toString().length());
+    }
+   EXPECT_EQ("1" + std::string(63U, '0'), BigInt::pow10(63U).toString());
+   EXPECT_EQ("1" + std::string(100000U, '0'), BigInt::pow10(100000U).toString());
+   EXPECT_EQ("1" + std::string(100000U, '0'), BigInt::pow10(100000U).toString());
+
+      // The cache is shared between threads.
+   std::vector<std::string> results (4U);
+   std::vector<std::thread> threads;
+   for (size_t i = 0U; i < results.size(); ++i)
+    {
+      threads.emplace_back([&results, i]() { results[i] = BigInt::pow10(100U + (i & 1U)).toString(); });
+    }
+   for (std::thread& thread : threads)
+    {
+      thread.join();
+    }
+   EXPECT_EQ("1" + std::string(100U, '0'), results[0]);
+   EXPECT_EQ("1" + std::string(101U, '0'), results[1]);
+   EXPECT_EQ(results[0], results[2]);
+   EXPECT_EQ(results[1], results[3]);
+
+      // Rescaling a big number by a power of ten, both ways.
+   BigInt::Integer big, q, r;
+   big.fromString("-123456789012345678901234567890");
+   EXPECT_EQ("-1234567890123456789012345678900000", (big * BigInt::pow10(4U)).toString());
+   EXPECT_EQ("-1234567890123456789012345678900000", (BigInt::pow10(4U) * big).toString());
+   quotrem(big, BigInt::pow10(7U), q, r);
+   EXPECT_EQ("-12345678901234567890123", q.toString());
+   EXPECT_EQ("-4567890", r.toString());
+   quotrem(big, BigInt::pow10(30U), q, r);
+   EXPECT_TRUE(q.isZero());
+   EXPECT_EQ(big.toString(), r.toString());
+   quotrem(big, -BigInt::pow10(10U), q, r);
+   EXPECT_EQ("12345678901234567890", q.toString());
+   EXPECT_EQ("-1234567890", r.toString());
+
+   BigInt::Fixed rescaled ("123456789012345678901234567890.0015");
+   rescaled.changePrecision(3U);
+   EXPECT_EQ("123456789012345678901234567890.002", rescaled.toString());
+   rescaled.changePrecision(40U);
+   EXPECT_EQ("123456789012345678901234567890.0020000000000000000000000000000000000000", rescaled.toString());
+ }
+
+TEST(FixedTests, testCompoundOperators)
+ {
+   const char* const values [] = { "0", "1.5", "-2", "0.125", "-123456789012345678901234.5", "98765432109876543210", "7.10", "-0.003" };
+   const size_t count = sizeof(values) / sizeof(values[0]);
+
+   for (size_t i = 0U; i < count; ++i)
+    {
+      for (size_t j = 0U; j < count; ++j)
+       {
+         const BigInt::Fixed lhs (values[i]), rhs (values[j]);
+         BigInt::Fixed sum (lhs), difference (lhs), product (lhs), quotient (lhs);
+         sum += rhs;
+         difference -= rhs;
+         product *= rhs;
+         quotient /= rhs;
+         EXPECT_EQ((lhs + rhs).toString(), sum.toString());
+         EXPECT_EQ((lhs - rhs).toString(), difference.toString());
+         EXPECT_EQ((lhs * rhs).toString(), product.toString());
+         EXPECT_EQ((lhs / rhs).toString(), quotient.toString());
+
+            // Again, with storage that nothing else shares.
+         BigInt::Fixed own (values[i]);
+         own *= BigInt::Fixed("1000000000000000000000");
+         own += rhs;
+         own -= rhs;
+         own *= rhs;
+         EXPECT_EQ((lhs * BigInt::Fixed("1000000000000000000000") * rhs).toString(), own.toString());
+       }
+    }
+
+      // Each with itself.
+   BigInt::Fixed self ("-123456789012345678901234.5");
+   self *= self;
+   EXPECT_EQ("15241578753238836750495334799573386691205623990.2", self.toString());
+   self += self;
+   EXPECT_EQ("30483157506477673500990669599146773382411247980.4", self.toString());
+   self -= self;
+   EXPECT_TRUE(self.isZero());
+   EXPECT_FALSE(self.isSigned());
+
+   BigInt::Fixed special ("1");
+   special /= BigInt::Fixed("0");
+   EXPECT_TRUE(special.isInf());
+   special -= special;
+   EXPECT_TRUE(special.isNaN());
+
+   BigInt::Integer counter;
+   counter.decrement();
+   EXPECT_EQ("-1", counter.toString());
+   counter.increment().increment();
+   EXPECT_EQ("1", counter.toString());
+   counter.fromString("18446744073709551615");
+   counter.increment();
+   EXPECT_EQ("18446744073709551616", counter.toString());
+   counter.decrement();
+   EXPECT_EQ("18446744073709551615", counter.toString());
+
+   BigInt::Integer moved (std::move(counter));
+   EXPECT_EQ("18446744073709551615", moved.toString());
+ }
+
+TEST(FixedTests, testFusedOperations)
+ {
+   const char* const values [] = { "0", "1.5", "-2", "0.125", "-123456789012345678901234.5", "98765432109876543210", "7.10", "-0.003" };
+   const size_t count = sizeof(values) / sizeof(values[0]);
+
+      // Both are what the two steps give, at precisions that do and don't round the product.
+   for (unsigned long precision = 0U; precision < 8U; precision += 3U)
+    {
+      const BigInt::Fixed_Context with (precision, BigInt::ROUND_TIES_EVEN);
+      BigInt::Fixed fold ("0");
+      BigInt::Fixed_Accumulator dot;
+      for (size_t i = 0U; i < count; ++i)
+       {
+         for (size_t j = 0U; j < count; ++j)
+          {
+            const BigInt::Fixed a (values[i]), b (values[j]), c (values[(i + j) % count]);
+            const BigInt::Fixed expected = BigInt::Fixed::multiply(a, b, with) + c;
+            const BigInt::Fixed got = BigInt::Fixed::multiplyAdd(a, b, c, with);
+            EXPECT_EQ(expected.toString(), got.toString());
+            EXPECT_EQ(expected.getPrecision(), got.getPrecision());
+
+            fold = fold + BigInt::Fixed::multiply(a, b, with);
+            dot.addProduct(a, b, with);
+            EXPECT_EQ(fold.toString(), dot.get().toString());
+          }
+       }
+    }
+
+      // An exact product is added straight into the addend, whichever has the larger scale. A rounded one is made first.
+   const BigInt::Fixed_Context exact (10U, BigInt::ROUND_TIES_EVEN), rounded (1U, BigInt::ROUND_TIES_EVEN);
+   EXPECT_EQ("-3.4375", BigInt::Fixed::multiplyAdd(BigInt::Fixed("1.25"), BigInt::Fixed("-2.75"), BigInt::Fixed("0"), exact).toString());
+   EXPECT_EQ("0.00000000", BigInt::Fixed::multiplyAdd(BigInt::Fixed("1.25"), BigInt::Fixed("-2.75"), BigInt::Fixed("3.43750000"), exact).toString());
+   EXPECT_EQ("99999999999999999999.4", BigInt::Fixed::multiplyAdd(BigInt::Fixed("-0.2"), BigInt::Fixed("3"), BigInt::Fixed("100000000000000000000"), exact).toString());
+   EXPECT_EQ("-3.44", BigInt::Fixed::multiplyAdd(BigInt::Fixed("1.25"), BigInt::Fixed("-2.75"), BigInt::Fixed("0"), rounded).toString());
+   EXPECT_EQ("-2.440", BigInt::Fixed::multiplyAdd(BigInt::Fixed("1.25"), BigInt::Fixed("-2.75"), BigInt::Fixed("1.000"), rounded).toString());
+
+   const BigInt::Fixed n (false, true), i (true, false), z ("0"), one ("1");
+   const BigInt::Fixed_Context with;
+   EXPECT_TRUE(BigInt::Fixed::multiplyAdd(i, z, one, with).isNaN());
+   EXPECT_TRUE(BigInt::Fixed::multiplyAdd(one, one, i, with).isInf());
+   EXPECT_TRUE(BigInt::Fixed::multiplyAdd(n, one, one, with).isNaN());
+   BigInt::Fixed_Accumulator special;
+   special.addProduct(i, one, with);
+   EXPECT_TRUE(special.get().isInf());
+   special.addProduct(one, one, with);
+   EXPECT_TRUE(special.get().isInf());
+   special.addProduct(i, one, with);
+   EXPECT_TRUE(special.get().isNaN());
+
+   BigInt::Integer sum, big;
+   big.fromString("-98765432109876543210987654321");
+   sum.fromString("100000000000000000000000000000000000000");
+   sum.addProduct(big, big);
+   EXPECT_EQ("9754610579850632525972580399356500533456774881877789971041", sum.toString());
+   sum.addProduct(-big, big);
+   EXPECT_EQ("100000000000000000000000000000000000000", sum.toString());
+   sum.addProduct(BigInt::pow10(19U), -BigInt::pow10(19U));
+   EXPECT_EQ("0", sum.toString());
+   EXPECT_FALSE(sum.isSigned());
+ }
+
+TEST(FixedTests, testPooledMemory)
+ {
+      // Numbers grow through every block size and past them, on several threads, freeing as they go.
+   std::vector<std::string> results (4U);
+   std::vector<std::thread> threads;
+   for (size_t i = 0U; i < results.size(); ++i)
+    {
+      threads.emplace_back([&results, i]()
+       {
+         BigInt::Integer value (static_cast<unsigned long>(i + 2U)), sum;
+         for (size_t j = 0U; j < 14U; ++j)
+          {
+            value = value * value;
+            sum += value;
+          }
+         for (size_t j = 0U; j < 14U; ++j)
+          {
+            sum -= value;
+            value.fromString(value.toString());
+          }
+         results[i] = sum.toString();
+         BigInt::releasePooledMemory();
+       });
+    }
+   for (std::thread& thread : threads)
+    {
+      thread.join();
+    }
+   for (size_t i = 0U; i < results.size(); ++i)
+    {
+      BigInt::Integer value (static_cast<unsigned long>(i + 2U)), sum;
+      for (size_t j = 0U; j < 14U; ++j)
+       {
+         value = value * value;
+         sum = sum + value;
+       }
+      sum = sum - BigInt::Integer(14U) * value;
+      EXPECT_EQ(sum.toString(), results[i]);
+    }
+
+      // Storage freed after a release is still good to use.
+   BigInt::Fixed big ("123456789012345678901234567890.5");
+   BigInt::releasePooledMemory();
+   EXPECT_EQ("15241578753238836750495351562659655576514250878776253619990.2", (big * big).toString());
+ }
+
+TEST(FixedTests, testGiantNumbers)
+ {
+      // Two to the 2^25 is four megabytes of limbs: past where blocks are mapped rather than allocated.
+   BigInt::Integer big (2U), copy, q, r;
+   for (size_t i = 0U; i < 25U; ++i)
+    {
+      big = big * big;
+    }
+   copy = big;
+   BigInt::Integer grown (big - BigInt::Integer(1U));
+
+      // Grow it in place, a word at a time, then take it back down.
+   for (size_t i = 0U; i < 64U; ++i)
+    {
+      grown *= BigInt::pow10(19U);
+    }
+   for (size_t i = 0U; i < 64U; ++i)
+    {
+      quotrem(grown, BigInt::pow10(19U), q, r);
+      EXPECT_TRUE(r.isZero());
+      grown = q;
+    }
+   EXPECT_EQ(0, (grown + BigInt::Integer(1U)).compare(copy));
+   EXPECT_FALSE(grown.isEven());
+
+   quotrem(big, big - BigInt::Integer(1U), q, r);
+   EXPECT_EQ("1", q.toString());
+   EXPECT_EQ("1", r.toString());
+ }
+
+TEST(FixedTests, testFormatting)
+ {
+   EXPECT_EQ("0", BigInt::Fixed("0").toString());
+   EXPECT_EQ("0.000", BigInt::Fixed("0.000").toString());
+   EXPECT_EQ("-0.005", BigInt::Fixed("-0.005").toString());
+   EXPECT_EQ("0.050", BigInt::Fixed(".050").toString());
+   EXPECT_EQ("-12.5", BigInt::Fixed("-12.5").toString());
+   EXPECT_EQ("18446744073709551615.9", BigInt::Fixed("18446744073709551615.9").toString());
+   EXPECT_EQ("-18446744073709551616", BigInt::Fixed("-18446744073709551616").toString());
+   EXPECT_EQ("-1844674407370955161.6", BigInt::Fixed("-1844674407370955161.6").toString());
+   EXPECT_EQ("0.00000000000000000000000000000000000000018446744073709551616",
+      BigInt::Fixed("0.00000000000000000000000000000000000000018446744073709551616").toString());
+
+      // A long fraction, and a long whole part: the zeros and digits all land where they should.
+   std::string digits (5000U, '7'), zeros (3000U, '0');
+   BigInt::Fixed fraction ("-0." + zeros + digits);
+   EXPECT_EQ("-0." + zeros + digits, fraction.toString());
+   BigInt::Fixed whole (digits + "." + digits.substr(0U, 123U));
+   EXPECT_EQ(digits + "." + digits.substr(0U, 123U), whole.toString());
+   BigInt::Integer integer;
+   integer.fromString("-" + digits);
+   EXPECT_EQ("-" + digits, integer.toString());
+ }
+
+TEST(FixedTests, testLeadingString)
+ {
+   EXPECT_EQ("-12.5", BigInt::Fixed("-12.5").leadingString(3U));
+   EXPECT_EQ("Infinity", BigInt::Fixed(true, false).leadingString(3U));
+
+      // Two to the 2^16 has almost twenty thousand digits: past where only the leading ones are converted.
+   BigInt::Fixed big ("2");
+   for (size_t i = 0U; i < 16U; ++i)
+    {
+      big = big * big;
+    }
+   BigInt::Fixed small = -big * BigInt::Fixed("0.001");
+   BigInt::Fixed tiny = small * BigInt::Fixed("0." + std::string(29999U, '0') + "1");
+   const std::string full = big.toString(), negative = small.toString(), fraction = tiny.toString();
+
+   for (size_t length : { 1U, 9U, 40U })
+    {
+      std::string shown = big.leadingString(length);
+      EXPECT_LT(length, shown.length());
+      EXPECT_EQ(full.substr(0U, length), shown.substr(0U, length));
+
+      shown = small.leadingString(length);
+      EXPECT_LT(length, shown.length());
+      EXPECT_EQ(negative.substr(0U, length), shown.substr(0U, length));
+
+      shown = tiny.leadingString(length);
+      EXPECT_LT(length, shown.length());
+      EXPECT_EQ(fraction.substr(0U, length), shown.substr(0U, length));
+    }
+
+      // A small number at a huge scale is only zeros after the point: it is shown without writing them all.
+   const BigInt::Fixed_Context fine (100000000U, BigInt::ROUND_TIES_EVEN);
+   BigInt::Fixed minute ("0.1");
+   for (size_t i = 0U; i < 26U; ++i)
+    {
+      minute = BigInt::Fixed::multiply(minute, minute, fine); // Ten to the -2^26
+    }
+   EXPECT_EQ("0.000000000", minute.leadingString(10U));
+   EXPECT_EQ("-0.00", (-minute).leadingString(4U));
+   EXPECT_EQ("12.0", BigInt::Fixed("12.000").leadingString(3U));
+   EXPECT_EQ("12.000", BigInt::Fixed("12.000").leadingString(20U));
+ }
+
+TEST(FixedTests, testLongLiterals)
+ {
+   std::string digits;
+   for (size_t i = 0U; i < 2500U; ++i)
+    {
+      digits += "1234567890987654321";
+    }
+
+      // Round trips, through the word at a time reader and the one that splits the digits in halves.
+   for (size_t length : { 19U, 20U, 999U, 1000U, 1001U, 2000U, 4001U, 47500U })
+    {
+      BigInt::Integer integer;
+      integer.fromString("-" + digits.substr(0U, length));
+      EXPECT_EQ("-" + digits.substr(0U, length), integer.toString());
+
+      const std::string whole = digits.substr(0U, length / 3U), fraction = digits.substr(length / 3U, length - length / 3U);
+      EXPECT_EQ(whole + "." + fraction, BigInt::Fixed(whole + "." + fraction).toString());
+      EXPECT_EQ("-" + whole + "." + fraction, BigInt::Fixed("-" + whole + "," + fraction).toString());
+    }
+
+      // Leading zeros, on either side of the point.
+   std::string zeros (3000U, '0');
+   EXPECT_EQ(digits.substr(0U, 1500U), BigInt::Fixed(zeros + digits.substr(0U, 1500U)).toString());
+   EXPECT_EQ("0." + zeros + "5", BigInt::Fixed("." + zeros + "5").toString());
+   EXPECT_EQ("-0." + zeros + "5", BigInt::Fixed("-0." + zeros + "5").toString());
+   EXPECT_EQ("12.3", BigInt::Fixed("123e-1").toString());
+   EXPECT_EQ("1230.0", BigInt::Fixed("12.3e2").toString());
+   EXPECT_EQ("0", BigInt::Fixed("-0.").toString());
+   BigInt::Integer zero;
+   zero.fromString("-" + zeros);
+   EXPECT_EQ("0", zero.toString());
+   zero.fromString(zeros + "7");
+   EXPECT_EQ("7", zero.toString());
+
+   BigInt::Integer parts;
+   parts.fromDigits("12", 2U, "345", 3U);
+   EXPECT_EQ("12345", parts.toString());
+   parts.fromDigits("", 0U);
+   EXPECT_TRUE(parts.isZero());
+ }
+
+TEST(FixedTests, testMixedScaleComparisons)
+ {
+   const char* values [] = { "-1e30", "-12345678901234567890123.25", "-2.5000", "-2.5", "-0.000001", "0", "0.0000",
+      "0.000000000000000000000000000001", "1.5", "1.50000000000000000000000000", "1.50000000000000000000000001",
+      "18446744073709551615.5", "18446744073709551616", "99999999999999999999999999999.999", "1e29" };
+   const int order [] = { 0, 1, 2, 2, 3, 4, 4, 5, 6, 6, 7, 8, 9, 10, 11 }; // Equal values have equal ranks.
+   const size_t count = sizeof(order) / sizeof(order[0]);
+
+   for (size_t i = 0U; i < count; ++i)
+    {
+      for (size_t j = 0U; j < count; ++j)
+       {
+         const int expected = (order[i] < order[j]) ? -1 : ((order[i] > order[j]) ? 1 : 0);
+         const int result = BigInt::Fixed(values[i]).compare(BigInt::Fixed(values[j]));
+         EXPECT_EQ(expected, (result < 0) ? -1 : ((result > 0) ? 1 : 0)) << values[i] << " " << values[j];
+       }
+    }
+
+      // Close enough that only scaling one of them will tell.
+   BigInt::Fixed big ("2");
+   for (size_t i = 0U; i < 12U; ++i)
+    {
+      big = big * big;
+    }
+   BigInt::Fixed wider = big + BigInt::Fixed("0." + std::string(40U, '0') + "1");
+   EXPECT_LT(big.compare(wider), 0);
+   EXPECT_GT(wider.compare(big), 0);
+   EXPECT_EQ(0, (big + BigInt::Fixed("0." + std::string(40U, '0'))).compare(big));
+   EXPECT_GT((-big).compare(-wider), 0);
+ }
+
+TEST(FixedTests, testDivisor)
+ {
+   std::string digits;
+   for (size_t i = 0U; i < 6000U; ++i)
+    {
+      digits += "31415926535897932384";
+    }
+
+      // A divisor of 22,000 digits is past where the reciprocal is used. Dividends of different lengths make it grow and shrink.
+   BigInt::Fixed divisor (digits.substr(0U, 21997U) + "." + digits.substr(7U, 3U));
+   BigInt::Fixed_Divisor by (divisor);
+   const size_t lengths [] = { 30000U, 50000U, 30000U, 100000U, 21000U, 45000U, 5U };
+   const BigInt::Fixed_Round_Mode modes [] = { BigInt::ROUND_TIES_EVEN, BigInt::ROUND_AWAY, BigInt::ROUND_ZERO };
+   for (size_t i = 0U; i < sizeof(lengths) / sizeof(lengths[0]); ++i)
+    {
+      const std::string sign = (0U == (i & 1U)) ? "" : "-";
+      for (BigInt::Fixed_Round_Mode mode : modes)
+       {
+         for (unsigned long precision : { 0UL, 7UL, 30UL })
+          {
+            const BigInt::Fixed_Context with (precision, mode);
+            for (const std::string& fraction : { std::string(""), std::string(".25"), std::string(".1234567890123456789") })
+             {
+               BigInt::Fixed dividend (sign + digits.substr(i, lengths[i]) + fraction);
+               BigInt::Fixed expected = BigInt::Fixed::divide(dividend, divisor, with), result = by.divide(dividend, with);
+               EXPECT_EQ(expected.getPrecision(), result.getPrecision());
+               EXPECT_EQ(0, expected.compare(result)) << lengths[i] << " " << precision << fraction;
+             }
+          }
+       }
+    }
+
+   EXPECT_TRUE(by.matches(BigInt::Fixed(digits.substr(0U, 21997U) + "." + digits.substr(7U, 3U))));
+   EXPECT_FALSE(by.matches(BigInt::Fixed(digits.substr(0U, 21997U) + "." + digits.substr(7U, 3U) + "0")));
+   EXPECT_FALSE(by.matches(-divisor));
+
+      // Small divisors, and the special values, still divide as Fixed::divide does.
+   BigInt::Fixed_Divisor three (BigInt::Fixed("-3.0"));
+   EXPECT_EQ("-0.33333", three.divide(BigInt::Fixed("1"), BigInt::Fixed_Context(5U)).toString());
+   EXPECT_EQ("-0.33334", three.divide(BigInt::Fixed("1"), BigInt::Fixed_Context(5U, BigInt::ROUND_AWAY)).toString());
+   BigInt::Fixed_Divisor zero (BigInt::Fixed("0"));
+   EXPECT_TRUE(zero.divide(BigInt::Fixed("1"), BigInt::Fixed_Context(5U)).isInf());
+   EXPECT_TRUE(zero.divide(BigInt::Fixed("0"), BigInt::Fixed_Context(5U)).isNaN());
+ }
+
+TEST(FixedTests, testSquareRoot)
+ {
+   EXPECT_EQ("1.41421356237309504880", BigInt::Fixed::squareRoot(BigInt::Fixed("2"), BigInt::Fixed_Context(20U)).toString());
+   EXPECT_EQ("1.41421356237309504881", BigInt::Fixed::squareRoot(BigInt::Fixed("2"), BigInt::Fixed_Context(20U, BigInt::ROUND_AWAY)).toString());
+   EXPECT_EQ("1.4142135624", BigInt::Fixed::squareRoot(BigInt::Fixed("2.00000000000000000000000000"), BigInt::Fixed_Context(10U)).toString());
+   EXPECT_EQ("4.00", BigInt::Fixed::squareRoot(BigInt::Fixed("16"), BigInt::Fixed_Context(2U, BigInt::ROUND_AWAY)).toString());
+   EXPECT_EQ("0.000", BigInt::Fixed::squareRoot(BigInt::Fixed("0.0000"), BigInt::Fixed_Context(3U)).toString());
+   EXPECT_EQ("4294967295", BigInt::Fixed::squareRoot(BigInt::Fixed("18446744073709551615"), BigInt::Fixed_Context(0U, BigInt::ROUND_ZERO)).toString());
+   EXPECT_EQ("4294967296", BigInt::Fixed::squareRoot(BigInt::Fixed("18446744073709551615"), BigInt::Fixed_Context(0U)).toString());
+
+      // The root of 0.0025 is 0.05: exactly halfway at one digit, so each mode breaks the tie its own way.
+   BigInt::Fixed tie ("0.0025");
+   EXPECT_EQ("0.0", BigInt::Fixed::squareRoot(tie, BigInt::Fixed_Context(1U, BigInt::ROUND_TIES_EVEN)).toString());
+   EXPECT_EQ("0.1", BigInt::Fixed::squareRoot(tie, BigInt::Fixed_Context(1U, BigInt::ROUND_TIES_AWAY)).toString());
+   EXPECT_EQ("0.1", BigInt::Fixed::squareRoot(tie, BigInt::Fixed_Context(1U, BigInt::ROUND_TIES_ODD)).toString());
+   EXPECT_EQ("0.0", BigInt::Fixed::squareRoot(tie, BigInt::Fixed_Context(1U, BigInt::ROUND_TIES_ZERO)).toString());
+   EXPECT_EQ("0.1", BigInt::Fixed::squareRoot(tie, BigInt::Fixed_Context(1U, BigInt::ROUND_POSITIVE_INFINITY)).toString());
+   EXPECT_EQ("0.0", BigInt::Fixed::squareRoot(tie, BigInt::Fixed_Context(1U, BigInt::ROUND_NEGATIVE_INFINITY)).toString());
+   EXPECT_EQ("0.1", BigInt::Fixed::squareRoot(BigInt::Fixed("0.00250001"), BigInt::Fixed_Context(1U, BigInt::ROUND_TIES_EVEN)).toString());
+   EXPECT_EQ("0.05", BigInt::Fixed::squareRoot(tie, BigInt::Fixed_Context(2U, BigInt::ROUND_AWAY)).toString());
+   EXPECT_EQ("6", BigInt::Fixed::squareRoot(BigInt::Fixed("26"), BigInt::Fixed_Context(0U, BigInt::ROUND_DOUBLE)).toString());
+   EXPECT_EQ("5", BigInt::Fixed::squareRoot(BigInt::Fixed("25"), BigInt::Fixed_Context(0U, BigInt::ROUND_DOUBLE)).toString());
+
+   EXPECT_TRUE(BigInt::Fixed::squareRoot(BigInt::Fixed("-1"), BigInt::Fixed_Context(5U)).isNaN());
+   EXPECT_TRUE(BigInt::Fixed::squareRoot(BigInt::Fixed(false, true), BigInt::Fixed_Context(5U)).isNaN());
+   EXPECT_TRUE(BigInt::Fixed::squareRoot(BigInt::Fixed(true, false), BigInt::Fixed_Context(5U)).isInf());
+
+      // A long root is truncated when rounding to zero: its square is at most the radicand, and the next one's is more.
+   std::string digits;
+   for (size_t i = 0U; i < 150U; ++i)
+    {
+      digits += "31415926535897932384";
+    }
+   BigInt::Fixed radicand (digits + ".5");
+   BigInt::Fixed root = BigInt::Fixed::squareRoot(radicand, BigInt::Fixed_Context(1500U, BigInt::ROUND_ZERO));
+   BigInt::Fixed next = root + BigInt::Fixed("0." + std::string(1499U, '0') + "1");
+   EXPECT_EQ(1500U, root.getPrecision());
+   EXPECT_TRUE(BigInt::Fixed::multiply(root, root, BigInt::Fixed_Context(3000U)) <= radicand);
+   EXPECT_TRUE(BigInt::Fixed::multiply(next, next, BigInt::Fixed_Context(3000U)) > radicand);
+   EXPECT_EQ(0, BigInt::Fixed::squareRoot(radicand, BigInt::Fixed_Context(1500U, BigInt::ROUND_AWAY)).compare(next));
+ }
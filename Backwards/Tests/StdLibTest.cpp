@@ -118,6 +118,19 @@ TEST(EngineTests, testFunctionsWithContext)
    EXPECT_EQ("FATAL: hello", logger.logs[0]);
    logger.logs.clear();
 
+    {
+      BigInt::Fixed_Context_Holder with (BigInt::Fixed_Context(5U, BigInt::ROUND_AWAY));
+      res = Backwards::Engine::Sqrt(context, makeFloatValue("2"));
+      ASSERT_TRUE(typeid(Backwards::Types::FloatValue) == typeid(*res.get()));
+      EXPECT_EQ("1.41422", std::dynamic_pointer_cast<Backwards::Types::FloatValue>(res)->value.toString());
+    }
+   EXPECT_TRUE(logger.logs.empty());
+   EXPECT_THROW(Backwards::Engine::Sqrt(context, makeFloatValue("-2")), Backwards::Engine::FatalException);
+   ASSERT_EQ(1U, logger.logs.size());
+   EXPECT_EQ("FATAL: imaginary result", logger.logs[0]);
+   logger.logs.clear();
+   EXPECT_THROW(Backwards::Engine::Sqrt(context, std::make_shared<Backwards::Types::StringValue>("hello")), Backwards::Types::TypedOperationException);
+
    EXPECT_THROW(Backwards::Engine::Info(context, makeFloatValue("1")), Backwards::Types::TypedOperationException);
    EXPECT_THROW(Backwards::Engine::Warn(context, makeFloatValue("1")), Backwards::Types::TypedOperationException);
    EXPECT_THROW(Backwards::Engine::Error(context, makeFloatValue("1")), Backwards::Types::TypedOperationException);
@@ -477,6 +490,30 @@ TEST(EngineTests, testArrayFunctions)
    EXPECT_THROW(Backwards::Engine::NewArrayDefault(std::make_shared<Backwards::Types::StringValue>("world"), makeFloatValue("2")), Backwards::Types::TypedOperationException);
    EXPECT_THROW(Backwards::Engine::NewArrayDefault(makeFloatValue("-1"), std::make_shared<Backwards::Types::StringValue>("world")), Backwards::Types::TypedOperationException);
    EXPECT_THROW(Backwards::Engine::NewArrayDefault(makeFloatValue("10000000000"), std::make_shared<Backwards::Types::StringValue>("world")), Backwards::Types::TypedOperationException);
+
+   res = Backwards::Engine::Sum(Backwards::Engine::NewArray());
+   ASSERT_TRUE(typeid(Backwards::Types::FloatValue) == typeid(*res.get()));
+   EXPECT_EQ("0", std::dynamic_pointer_cast<Backwards::Types::FloatValue>(res)->value.toString());
+
+      // The same as adding them up in order: the sum has the largest scale.
+   res = Backwards::Engine::NewArray();
+   BigInt::Fixed folded;
+   for (const char* value : { "1.5", "-2", "0.25", "3", "-0.125" })
+    {
+      res = Backwards::Engine::PushBack(res, makeFloatValue(value));
+      folded = folded + BigInt::Fixed(value);
+    }
+   left = Backwards::Engine::Sum(res);
+   ASSERT_TRUE(typeid(Backwards::Types::FloatValue) == typeid(*left.get()));
+   EXPECT_EQ("2.625", std::dynamic_pointer_cast<Backwards::Types::FloatValue>(left)->value.toString());
+   EXPECT_EQ(folded.toString(), std::dynamic_pointer_cast<Backwards::Types::FloatValue>(left)->value.toString());
+
+   left = Backwards::Engine::Sum(Backwards::Engine::PushBack(res, Backwards::Engine::NaN()));
+   ASSERT_TRUE(typeid(Backwards::Types::FloatValue) == typeid(*left.get()));
+   EXPECT_TRUE(std::dynamic_pointer_cast<Backwards::Types::FloatValue>(left)->value.isNaN());
+
+   EXPECT_THROW(Backwards::Engine::Sum(Backwards::Engine::PushBack(res, std::make_shared<Backwards::Types::StringValue>("world"))), Backwards::Types::TypedOperationException);
+   EXPECT_THROW(Backwards::Engine::Sum(makeFloatValue("2")), Backwards::Types::TypedOperationException);
  }
 
 TEST(EngineTests, testDictionaryFunctions)
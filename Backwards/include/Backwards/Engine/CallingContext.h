@@ -75,6 +75,9 @@ namespace Engine
 
       virtual std::shared_ptr<CallingContext> duplicate(); // This function exists for the debugger.
 
+         // Called before a global, or a variable of an enclosing scope, is set: that is a side effect that outlives the call.
+      virtual void beforeSharedWrite();
+
    private:
       std::vector<Scope*> scopes;
 
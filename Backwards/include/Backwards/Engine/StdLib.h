@@ -60,6 +60,7 @@ namespace Engine
    std::shared_ptr<Types::ValueType> x (const std::shared_ptr<Types::ValueType>& arg)
 
    STDLIB_UNARY_DECL(Sqr);
+   STDLIB_UNARY_DECL(Sum);
    STDLIB_UNARY_DECL(Abs);
    STDLIB_UNARY_DECL(Round);
    STDLIB_UNARY_DECL(Floor);
@@ -96,6 +97,7 @@ namespace Engine
    STDLIB_UNARY_DECL_WITH_CONTEXT(Info);
    STDLIB_UNARY_DECL_WITH_CONTEXT(DebugPrint);
    STDLIB_UNARY_DECL_WITH_CONTEXT(Eval);
+   STDLIB_UNARY_DECL_WITH_CONTEXT(Sqrt);
 
    STDLIB_UNARY_DECL_WITH_CONTEXT(EvalCell);
    STDLIB_UNARY_DECL_WITH_CONTEXT(ExpandRange);
@@ -40,6 +40,21 @@ namespace Backwards
 namespace Types
  {
 
+      /*
+         A for loop walks a range with a cursor, rather than asking for each index in turn.
+         A cursor may reuse the element that it last returned, if nothing else holds it by then,
+         so that walking a large range needn't allocate an element for every cell.
+      */
+   class CellRangeCursor
+    {
+   public:
+      CellRangeCursor() = default;
+      virtual ~CellRangeCursor() = default;
+
+      virtual bool hasNext() const = 0;
+      virtual std::shared_ptr<ValueType> next() = 0;
+    };
+
    class CellRangeHolder
     {
    public:
@@ -48,6 +63,7 @@ namespace Types
 
       virtual std::shared_ptr<ValueType> getIndex (size_t index) const = 0;
       virtual size_t getSize() const = 0;
+      virtual std::unique_ptr<CellRangeCursor> getCursor() const; // The default asks getIndex for each element.
 
       virtual bool equal (const CellRangeValue& lhs) const = 0;
       virtual bool notEqual (const CellRangeValue& lhs) const = 0;
@@ -71,6 +87,7 @@ namespace Types
 
       std::shared_ptr<ValueType> getIndex (size_t index) const;
       size_t getSize() const;
+      std::unique_ptr<CellRangeCursor> getCursor() const;
 
       bool equal (const CellRangeValue& lhs) const override;
       bool notEqual (const CellRangeValue& lhs) const override;
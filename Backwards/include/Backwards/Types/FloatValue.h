@@ -49,6 +49,7 @@ namespace Types
 
       FloatValue();
       explicit FloatValue(const BigInt::Fixed& value);
+      explicit FloatValue(BigInt::Fixed&& value); // Results of arithmetic are moved in, not copied.
 
       const std::string& getTypeName() const override;
 
@@ -101,6 +101,10 @@ namespace Engine
       result->pushScope(topScope());
     }
 
+   void CallingContext::beforeSharedWrite()
+    {
+    }
+
    LocalGetter::LocalGetter(size_t location) : location(location)
     {
     }
@@ -199,6 +203,7 @@ namespace Engine
 
    void GlobalSetter::set(CallingContext& context, const std::shared_ptr<Types::ValueType>& value) const
     {
+      context.beforeSharedWrite();
       context.globalScope->vars[location] = value;
     }
 
@@ -216,6 +221,7 @@ namespace Engine
        {
          throw FatalException("Write of local variable with bad location.");
        }
+      context.beforeSharedWrite();
       context.topScope()->vars[location] = value;
     }
 
@@ -37,6 +37,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Backwards/Types/ArrayValue.h"
 #include "Backwards/Types/DictionaryValue.h"
 #include "Backwards/Types/CellRangeValue.h"
+#include "Backwards/Types/NilValue.h"
 
 #include "Backwards/Engine/ConstantsSingleton.h"
 #include "Backwards/Engine/DebuggerHook.h"
@@ -572,9 +573,15 @@ namespace Engine
 
    static std::shared_ptr<FlowControl> rangeIter(CallingContext& context, std::shared_ptr<Types::CellRangeValue> currentValue, const std::shared_ptr<Setter>& setter, const std::shared_ptr<Statement>& seq, size_t id)
     {
-      for (size_t index = 0; index < currentValue->value->getSize(); ++index)
+      std::unique_ptr<Types::CellRangeCursor> cursor = currentValue->getCursor();
+      const std::shared_ptr<Types::ValueType> nothing = std::make_shared<Types::NilValue>();
+      for (bool first = true; true == cursor->hasNext(); first = false)
        {
-         setter->set(context, currentValue->value->getIndex(index));
+         if (false == first)
+          {
+            setter->set(context, nothing); // Let go of the last element, so that the cursor may reuse it.
+          }
+         setter->set(context, cursor->next());
 
          std::shared_ptr<FlowControl> temp = seq->execute(context);
 
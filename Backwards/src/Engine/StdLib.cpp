@@ -254,7 +254,7 @@ namespace Engine
     }
 
    //////////
-   // The other 36 functions of the Standard Library in no particular order. (Eval and EnterDebugger are not counted here.)
+   // The other 38 functions of the Standard Library in no particular order. (Eval and EnterDebugger are not counted here.)
    //////////
 
    STDLIB_BINARY_DECL(PushFront)
@@ -607,6 +607,46 @@ namespace Engine
        }
     }
 
+   STDLIB_UNARY_DECL_WITH_CONTEXT(Sqrt)
+    {
+      if (typeid(Types::FloatValue) == typeid(*arg))
+       {
+         const BigInt::Fixed& x = static_cast<const Types::FloatValue&>(*arg).value;
+         if (x.isSigned())
+          {
+            context.logger->log("FATAL: imaginary result");
+            throw FatalException("imaginary result");
+          }
+            // Correctly rounded, in this thread's scale and rounding mode.
+         return std::make_shared<Types::FloatValue>(BigInt::Fixed::squareRoot(x, BigInt::Fixed::getContext()));
+       }
+      else
+       {
+         throw Types::TypedOperationException("Error trying to compute square root of non-Float.");
+       }
+    }
+
+   STDLIB_UNARY_DECL(Sum)
+    {
+      if (typeid(Types::ArrayValue) == typeid(*arg))
+       {
+         BigInt::Fixed_Accumulator sum; // Gets what adding them up one at a time with + gets, without a new number each time.
+         for (const std::shared_ptr<Types::ValueType>& element : static_cast<const Types::ArrayValue&>(*arg).value)
+          {
+            if (typeid(Types::FloatValue) != typeid(*element))
+             {
+               throw Types::TypedOperationException("Error trying to sum non-Float.");
+             }
+            sum += static_cast<const Types::FloatValue&>(*element).value;
+          }
+         return std::make_shared<Types::FloatValue>(sum.get());
+       }
+      else
+       {
+         throw Types::TypedOperationException("Error trying to sum non-Array.");
+       }
+    }
+
    STDLIB_UNARY_DECL(ValueOf)
     {
       if (typeid(Types::StringValue) == typeid(*arg))
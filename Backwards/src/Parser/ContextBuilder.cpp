@@ -54,8 +54,9 @@ namespace Parser
     // 1
       addFunction("EnterDebugger", std::make_shared<Engine::StandardConstantFunctionWithContext>(Engine::EnterDebugger), 0U, global);
 
-    // 27
+    // 28
       addFunction("Sqr", std::make_shared<Engine::StandardUnaryFunction>(Engine::Sqr), 1U, global);
+      addFunction("Sum", std::make_shared<Engine::StandardUnaryFunction>(Engine::Sum), 1U, global);
       addFunction("Abs", std::make_shared<Engine::StandardUnaryFunction>(Engine::Abs), 1U, global);
       addFunction("Round", std::make_shared<Engine::StandardUnaryFunction>(Engine::Round), 1U, global);
       addFunction("Floor", std::make_shared<Engine::StandardUnaryFunction>(Engine::Floor), 1U, global);
@@ -83,7 +84,7 @@ namespace Parser
       addFunction("SetDefaultPrecision", std::make_shared<Engine::StandardUnaryFunction>(Engine::SetDefaultPrecision), 1U, global);
       addFunction("GetPrecision", std::make_shared<Engine::StandardUnaryFunction>(Engine::GetPrecision), 1U, global);
 
-    // 8
+    // 9
       addFunction("Error", std::make_shared<Engine::StandardUnaryFunctionWithContext>(Engine::Error), 1U, global);
       addFunction("Warn", std::make_shared<Engine::StandardUnaryFunctionWithContext>(Engine::Warn), 1U, global);
       addFunction("Info", std::make_shared<Engine::StandardUnaryFunctionWithContext>(Engine::Info), 1U, global);
@@ -92,6 +93,7 @@ namespace Parser
       addFunction("Eval", std::make_shared<Engine::StandardUnaryFunctionWithContext>(Engine::Eval), 1U, global);
       addFunction("EvalCell", std::make_shared<Engine::StandardUnaryFunctionWithContext>(Engine::EvalCell), 1U, global);
       addFunction("ExpandRange", std::make_shared<Engine::StandardUnaryFunctionWithContext>(Engine::ExpandRange), 1U, global);
+      addFunction("Sqrt", std::make_shared<Engine::StandardUnaryFunctionWithContext>(Engine::Sqrt), 1U, global);
 
     // 10
       addFunction("Min", std::make_shared<Engine::StandardBinaryFunction>(Engine::Min), 2U, global);
@@ -46,6 +46,25 @@ namespace Backwards
 namespace Types
  {
 
+   class IndexCursor final : public CellRangeCursor
+    {
+   public:
+      explicit IndexCursor(const CellRangeHolder& holder) : holder(holder), index(0U), size(holder.getSize()) { }
+
+      bool hasNext() const override { return index < size; }
+      std::shared_ptr<ValueType> next() override { return holder.getIndex(index++); }
+
+   private:
+      const CellRangeHolder& holder;
+      size_t index;
+      size_t size;
+    };
+
+   std::unique_ptr<CellRangeCursor> CellRangeHolder::getCursor() const
+    {
+      return std::make_unique<IndexCursor>(*this);
+    }
+
    CellRangeValue::CellRangeValue()
     {
     }
@@ -70,6 +89,11 @@ namespace Types
       return value->getSize();
     }
 
+   std::unique_ptr<CellRangeCursor> CellRangeValue::getCursor () const
+    {
+      return value->getCursor();
+    }
+
    bool CellRangeValue::equal (const CellRangeValue& lhs) const
     {
       return value->equal(lhs);
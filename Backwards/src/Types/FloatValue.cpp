@@ -56,6 +56,10 @@ namespace Types
     {
     }
 
+   FloatValue::FloatValue(BigInt::Fixed&& value) : value(std::move(value))
+    {
+    }
+
    const std::string& FloatValue::getTypeName() const
     {
       static const std::string name ("Float");
@@ -31,7 +31,11 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #include <ncurses.h>
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
 
 #include "Forwards/Engine/CallingContext.h"
@@ -48,13 +52,22 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Screen.h"
 #include "GetAndSet.h"
 
-const int RECALC_POLL_MILLIS = 40; // 25 Hz
 const int NO_INPUT_SLEEP_MILLIS = 10; // 100 Hz (when no input; always AFAP when processing input)
 
 const size_t MAX_ROW = 999999998U; // Yes, minus one.
 const size_t MAX_COL = 18277U;
 
-volatile bool blinky = true;
+   /*
+      The recalc thread and the UI share the sheet.
+      Whoever changes the sheet holds sheetLock: the recalc thread while it updates, and the UI while it edits.
+      To edit, the UI cancels the recalc in progress, which stops at the next cell, and takes the lock.
+      When the UI gives the lock back, the recalc starts again from whatever is still dirty.
+   */
+std::atomic<bool> blinky (true); // A recalc is wanted, or one was cancelled before it finished.
+std::atomic<bool> running (false); // The recalc thread is in an update.
+std::mutex sheetLock;
+std::condition_variable recalcSignal;
+std::unique_lock<std::mutex> editLock (sheetLock, std::defer_lock); // The UI's hold on the sheet.
 std::thread updateThread;
 
 void GetRC(const std::string& from, int64_t& col, int64_t& row)
@@ -118,9 +131,18 @@ std::string setComma(const std::string& str, bool useComma)
    return result;
  }
 
-std::string getStringPreviousValue(Forwards::Engine::Cell* curCell, SharedData& data)
+std::string getStringShownValue(Forwards::Engine::Cell* curCell, SharedData& data)
  {
-   std::string content = curCell->previousValue->toString(data.c_col, data.c_row);
+   std::string content = curCell->shown().value->toString(data.c_col, data.c_row);
+   if (Forwards::Engine::VALUE == curCell->type) content = setComma(content, data.useComma);
+   return content;
+ }
+
+   // Only convert the digits of a number that there is room to show: it may have millions of them.
+std::string getStringShownValue(Forwards::Engine::Cell* curCell, SharedData& data, size_t width)
+ {
+   if (Forwards::Types::FLOAT != curCell->shown().value->getType()) return getStringShownValue(curCell, data);
+   std::string content = static_cast<const Forwards::Types::FloatValue&>(*curCell->shown().value).value.leadingString(width);
    if (Forwards::Engine::VALUE == curCell->type) content = setComma(content, data.useComma);
    return content;
  }
@@ -135,16 +157,44 @@ std::string getStringDisplayValue(Forwards::Engine::Cell* curCell, SharedData& d
 
 void threadrun (SharedData& data)
  {
-   std::chrono::system_clock::time_point last;
+   Forwards::Engine::SpreadSheet* sheet = data.context->theSheet;
+   std::unique_lock<std::mutex> lock (sheetLock);
    for (;;)
     {
-      if (true == blinky)
+      recalcSignal.wait(lock, [sheet] () { return (true == blinky) && (false == sheet->cancelled); });
+      running = true;
+      sheet->update(*data.context);
+      running = false;
+      if (false == sheet->cancelled)
        {
-         data.context->theSheet->recalc(*data.context);
          blinky = false;
+         recalcSignal.notify_all();
        }
-      last = std::chrono::system_clock::now() + std::chrono::milliseconds(RECALC_POLL_MILLIS);
-      std::this_thread::sleep_until(last);
+    }
+ }
+
+   // Stop the recalc at the next cell, and take the sheet from the recalc thread.
+void StopRecalc(SharedData& data)
+ {
+   if (false == editLock.owns_lock())
+    {
+      data.context->theSheet->cancelled = true;
+      editLock.lock();
+      data.context->theSheet->cancelled = false;
+    }
+ }
+
+   // Give the sheet back to the recalc thread. It restarts if the sheet changed, or if it was cancelled.
+void StartRecalc(bool changed)
+ {
+   if (true == editLock.owns_lock())
+    {
+      if (true == changed)
+       {
+         blinky = true;
+       }
+      editLock.unlock();
+      recalcSignal.notify_all();
     }
  }
 
@@ -171,6 +221,7 @@ void InitScreen(SharedData& data)
 
 void UpdateScreen(SharedData& data)
  {
+   std::lock_guard<std::mutex> snapshot (data.context->theSheet->snapshotLock); // Show the last finished recalc, while the next one runs.
    int x, y, mx, my;
    getmaxyx(stdscr, y, x); // CODING HORROR!!!
    mx = 0;
@@ -196,9 +247,9 @@ void UpdateScreen(SharedData& data)
             printw("LABEL ");
           }
 
-         if (nullptr != curCell->previousValue)
+         if (nullptr != curCell->shown().value)
           {
-            std::string content = getStringPreviousValue(curCell, data);
+            std::string content = getStringShownValue(curCell, data, x - 23);
             if (content.size() > static_cast<size_t>(x - 23)) content.resize(x - 23);
             printw("%s", content.c_str());
             for (int i = (x - 22 - content.size()); i > 0; --i) addch(' ');
@@ -220,6 +271,13 @@ void UpdateScreen(SharedData& data)
        }
       if (true == blinky)
        {
+         const size_t total = data.context->theSheet->progressTotal;
+         if ((true == running) && (0U != total) && (x > 24))
+          {
+            const size_t done = std::min(data.context->theSheet->progress.load(), total);
+            move(0, x - 8);
+            printw("%4d%%", static_cast<int>(done * 100U / total));
+          }
          addch('#');
        }
       else
@@ -243,7 +301,7 @@ void UpdateScreen(SharedData& data)
       if (nullptr != curCell)
        {
             // unfinished VALUE : parse current contents
-         if ((false == blinky) && (Forwards::Engine::VALUE == curCell->type) && (nullptr == curCell->value))
+         if (((true == editLock.owns_lock()) || (false == blinky)) && (Forwards::Engine::VALUE == curCell->type) && (nullptr == curCell->value))
           {
             data.context->inUserInput = true;
             --data.context->generation;
@@ -406,16 +464,16 @@ void UpdateScreen(SharedData& data)
             Forwards::Engine::Cell* curCell = data.context->theSheet->getCellAt(cc, cr);
             if (nullptr != curCell)
              {
-               if (true == curCell->recursed)
+               if (true == curCell->shown().recursed)
                 {
                   attron(COLOR_PAIR(5));
                 }
-               if (nullptr != curCell->previousValue)
+               if (nullptr != curCell->shown().value)
                 {
-                  std::string content = getStringPreviousValue(curCell, data);
+                  std::string content = getStringShownValue(curCell, data, nextWidth);
                   if (content.size() > static_cast<size_t>(nextWidth))
                    {
-                     if (Forwards::Types::FLOAT == curCell->previousValue->getType()) // Make numbers note that they are truncated.
+                     if (Forwards::Types::FLOAT == curCell->shown().value->getType()) // Make numbers note that they are truncated.
                       {
                         content.resize(nextWidth - 1);
                         content += "#";
@@ -427,7 +485,7 @@ void UpdateScreen(SharedData& data)
                    }
                   if (content.size() < static_cast<size_t>(nextWidth))
                    {
-                     if (Forwards::Types::FLOAT == curCell->previousValue->getType()) // Left pad numbers
+                     if (Forwards::Types::FLOAT == curCell->shown().value->getType()) // Left pad numbers
                       {
                         while (content.size() < static_cast<size_t>(nextWidth)) content = " " + content;
                       }
@@ -723,7 +781,8 @@ int ProcessInput(SharedData& data)
             curCell->currentInput = data.tempString;
             curCell->value.reset();
             curCell->previousValue.reset();
-            blinky = true;
+            data.context->theSheet->markDirty(data.c_col, data.c_row);
+            StartRecalc(true);
           }
          else if (GOTO_CELL == data.mode)
           {
@@ -740,7 +799,8 @@ int ProcessInput(SharedData& data)
             curCell->currentInput = data.tempString;
             data.tempString = "";
             data.origString = "";
-            blinky = true;
+            data.context->theSheet->markDirty(data.c_col, data.c_row);
+            StartRecalc(true);
             done = false;
             if (KEY_NPAGE == c)
              {
@@ -758,6 +818,7 @@ int ProcessInput(SharedData& data)
          if (CELL_MODIFICATION == data.mode)
           {
             curCell->currentInput = data.origString;
+            StartRecalc(false);
           }
          data.tempString = "";
          data.origString = "";
@@ -879,7 +940,7 @@ int ProcessInput(SharedData& data)
       data.tr_row = 0U;
       break;
    case '<':
-      if (true == blinky) break;
+      StopRecalc(data);
     {
       if (nullptr == curCell)
        {
@@ -902,7 +963,7 @@ int ProcessInput(SharedData& data)
     }
       break;
    case '=':
-      if (true == blinky) break;
+      StopRecalc(data);
     {
       if (nullptr == curCell)
        {
@@ -938,11 +999,13 @@ int ProcessInput(SharedData& data)
        }
       break;
    case '!':
-      blinky = true;
+      StopRecalc(data);
+      data.context->theSheet->markAllDirty();
+      StartRecalc(true);
       break;
    case 'd':
       if (false == updateChOrFail(c, data)) break;
-      if (true == blinky) break;
+      StopRecalc(data);
       switch (c)
        {
       case 'd':
@@ -955,11 +1018,11 @@ int ProcessInput(SharedData& data)
          data.context->theSheet->clearRow(data.c_row);
          break;
        }
-      blinky = true;
+      StartRecalc(true);
       break;
    case 'y':
       if (false == updateChOrFail(c, data)) break;
-      if (true == blinky) break;
+      StopRecalc(data);
       if ('y' == c)
        {
          if ((nullptr != curCell) && (nullptr != curCell->value.get()))
@@ -968,10 +1031,11 @@ int ProcessInput(SharedData& data)
             data.yanked = curCell->value;
           }
        }
+      StartRecalc(false);
       break;
    case 'p':
       if (false == updateChOrFail(c, data)) break;
-      if (true == blinky) break;
+      StopRecalc(data);
       if ('p' == c)
        {
          if (nullptr == curCell)
@@ -981,11 +1045,12 @@ int ProcessInput(SharedData& data)
           }
          curCell->type = data.yankedType;
          curCell->value = data.yanked;
-         blinky = true;
+         data.context->theSheet->markDirty(data.c_col, data.c_row);
        }
+      StartRecalc('p' == c);
       break;
    case 'e':
-      if (true == blinky) break;
+      StopRecalc(data);
     {
       if (nullptr != curCell)
        {
@@ -1010,6 +1075,10 @@ int ProcessInput(SharedData& data)
          data.tempString = curCell->currentInput;
          data.mode = CELL_MODIFICATION;
        }
+      else
+       {
+         StartRecalc(false);
+       }
     }
       break;
    case 'W':
@@ -1040,7 +1109,7 @@ int ProcessInput(SharedData& data)
       data.useComma = !data.useComma;
       break;
    case '+':
-      if (true == blinky) break;
+      StopRecalc(data);
     {
       if (nullptr == curCell)
        {
@@ -1117,17 +1186,11 @@ int ProcessInput(SharedData& data)
          size_t maxRow = 0U;
          if (data.c_col < data.context->theSheet->sheet.size())
           {
-            maxRow = data.context->theSheet->sheet[data.c_col].size();
-          }
-         while (nullptr == data.context->theSheet->getCellAt(data.c_col, maxRow))
-          {
-            if (0 != maxRow)
-             {
-               --maxRow;
-             }
-            else
+            const Forwards::Engine::Column& column = data.context->theSheet->sheet[data.c_col];
+            maxRow = column.previous(column.size());
+            if (Forwards::Engine::Column::NONE == maxRow)
              {
-               break;
+               maxRow = 0U;
              }
           }
          data.c_row = maxRow;
@@ -1145,7 +1208,7 @@ int ProcessInput(SharedData& data)
       break;
    case 'x':
       if (false == updateChOrFail(c, data)) break;
-      if (true == blinky) break;
+      StopRecalc(data);
       switch (c)
        {
       case 'x':
@@ -1162,11 +1225,11 @@ int ProcessInput(SharedData& data)
          data.context->theSheet->removeRow(data.c_row);
          break;
        }
-      blinky = true;
+      StartRecalc(true);
       break;
    case 'i':
       if (false == updateChOrFail(c, data)) break;
-      if (true == blinky) break;
+      StopRecalc(data);
       switch (c)
        {
       case 'i':
@@ -1180,11 +1243,11 @@ int ProcessInput(SharedData& data)
          data.context->theSheet->insertRowBefore(data.c_row);
          break;
        }
-      blinky = true;
+      StartRecalc(true);
       break;
    case 'o':
       if (false == updateChOrFail(c, data)) break;
-      if (true == blinky) break;
+      StopRecalc(data);
       switch (c)
        {
       case 'o':
@@ -1198,22 +1261,23 @@ int ProcessInput(SharedData& data)
          data.context->theSheet->insertRowBefore(data.c_row + 1U);
          break;
        }
-      blinky = true;
+      StartRecalc(true);
       break;
    case 'v':
       if (false == updateChOrFail(c, data)) break;
-      if (true == blinky) break;
+      StopRecalc(data);
       if ('v' == c)
        {
          if (nullptr != curCell)
           {
-            if (("" == curCell->currentInput) && (nullptr != curCell->value.get()) && (nullptr != curCell->previousValue.get()))
+            if (("" == curCell->currentInput) && (nullptr != curCell->value.get()) && (nullptr != curCell->shown().value.get()))
              {
-               curCell->currentInput = getStringPreviousValue(curCell, data);
+               curCell->currentInput = getStringShownValue(curCell, data);
                curCell->value.reset();
              }
           }
        }
+      StartRecalc(false);
       break;
    case '`':
       endwin();
@@ -1225,12 +1289,9 @@ int ProcessInput(SharedData& data)
 
 void WaitToSave(void)
  {
-   std::chrono::system_clock::time_point last;
-   while (true == blinky)
-    {
-      last = std::chrono::system_clock::now() + std::chrono::milliseconds(RECALC_POLL_MILLIS);
-      std::this_thread::sleep_until(last);
-    }
+   StartRecalc(false);
+   std::unique_lock<std::mutex> lock (sheetLock);
+   recalcSignal.wait(lock, [] () { return false == blinky; });
  }
 
 void DestroyScreen(void)
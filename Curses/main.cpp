@@ -30,6 +30,7 @@ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #include <iostream>
+#include <thread>
 
 #include "Backwards/Engine/Logger.h"
 
@@ -59,6 +60,11 @@ int main (int argc, char ** argv)
    context.logger = &logger;
    Forwards::Engine::SpreadSheet sheet;
    context.theSheet = &sheet;
+   sheet.threads = std::thread::hardware_concurrency();
+   if (0U == sheet.threads)
+    {
+      sheet.threads = 1U;
+    }
    Forwards::Engine::GetterMap map;
    context.map = &map;
    Forwards::Engine::NameMap names;
@@ -110,6 +116,14 @@ int main (int argc, char ** argv)
 
    fileLibs.insert(fileLibs.end(), argLibs.begin(), argLibs.end());
    LoadLibraries(fileLibs, context);
+   context.numeric = BigInt::Fixed::getContext(); // The libraries may have set the scale or rounding mode.
+
+      // Parse the whole sheet now, on every core, rather than one cell at a time in the first recalc.
+      // The libraries have to be loaded first, as formulas may call their functions.
+   for (const std::pair<const Forwards::Engine::CellLocation, std::string>& error : sheet.parseAll(context))
+    {
+      logger.log("Failed to parse " + Forwards::Types::ValueType::columnToString(error.first.first) + std::to_string(error.first.second + 1U) + ": " + error.second);
+    }
 
 
    if (false == batches.empty())
@@ -1130,6 +1130,75 @@ TEST(EngineTests, testParens)
    EXPECT_EQ("6-6*9", minus2.toString(1U, 1U, 0));
  }
 
+TEST(EngineTests, testFusedMultiplyAdd)
+ {
+   const char* const values [] = { "1.5", "-0.25", "123456789012345678901234.5678", "3", "0.001" };
+   const size_t count = sizeof(values) / sizeof(values[0]);
+   Forwards::Engine::CallingContext context;
+   StringLogger logger;
+   context.logger = &logger;
+
+      // Whichever side the product is on, the sum is what the two steps give, at each precision.
+   for (unsigned long precision = 0U; precision < 6U; precision += 5U)
+    {
+      BigInt::Fixed::setDefaultPrecision(precision);
+      for (size_t i = 0U; i < count; ++i)
+       {
+         for (size_t j = 0U; j < count; ++j)
+          {
+            const BigInt::Fixed a (values[i]), b (values[j]), c (values[(i + j) % count]);
+            std::shared_ptr<Forwards::Engine::Constant> A = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue(values[i]));
+            std::shared_ptr<Forwards::Engine::Constant> B = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue(values[j]));
+            std::shared_ptr<Forwards::Engine::Constant> C = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue(values[(i + j) % count]));
+            std::shared_ptr<Forwards::Engine::Multiply> product = std::make_shared<Forwards::Engine::Multiply>(Forwards::Input::Token(), A, B);
+
+            Forwards::Engine::Plus after (Forwards::Input::Token(), product, C);
+            Forwards::Engine::Plus before (Forwards::Input::Token(), C, product);
+            std::shared_ptr<Forwards::Types::ValueType> res = after.evaluate(context);
+            ASSERT_TRUE(typeid(Forwards::Types::FloatValue) == typeid(*res.get()));
+            EXPECT_EQ((a * b + c).toString(), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(res)->value.toString());
+            res = before.evaluate(context);
+            ASSERT_TRUE(typeid(Forwards::Types::FloatValue) == typeid(*res.get()));
+            EXPECT_EQ((c + a * b).toString(), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(res)->value.toString());
+          }
+       }
+    }
+   BigInt::Fixed::setDefaultPrecision(0U);
+
+      // Anything that isn't a number goes the long way, with the same results and errors.
+   std::shared_ptr<Forwards::Engine::Constant> num = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("2"));
+   std::shared_ptr<Forwards::Engine::Constant> nil = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), std::make_shared<Forwards::Types::NilValue>());
+   std::shared_ptr<Forwards::Engine::Constant> str = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), std::make_shared<Forwards::Types::StringValue>("x"));
+   std::shared_ptr<Forwards::Engine::Multiply> twice = std::make_shared<Forwards::Engine::Multiply>(Forwards::Input::Token(), num, num);
+   std::shared_ptr<Forwards::Engine::Multiply> nilProduct = std::make_shared<Forwards::Engine::Multiply>(Forwards::Input::Token(), nil, num);
+   std::shared_ptr<Forwards::Engine::Multiply> badProduct = std::make_shared<Forwards::Engine::Multiply>(Forwards::Input::Token(), str, num);
+
+   Forwards::Engine::Plus plusNil (Forwards::Input::Token(), twice, nil);
+   EXPECT_EQ(BigInt::Fixed("4"), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(plusNil.evaluate(context))->value);
+   Forwards::Engine::Plus nilPlus (Forwards::Input::Token(), nilProduct, num);
+   EXPECT_EQ(BigInt::Fixed("2"), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(nilPlus.evaluate(context))->value);
+   Forwards::Engine::Plus badFirst (Forwards::Input::Token(), badProduct, str);
+   try
+    {
+      badFirst.evaluate(context);
+      FAIL() << "Adding to a bad product worked.";
+    }
+   catch (const Backwards::Types::TypedOperationException& e)
+    {
+      EXPECT_EQ(0U, std::string(e.what()).find("Error multiplying"));
+    }
+   Forwards::Engine::Plus badSum (Forwards::Input::Token(), twice, str);
+   try
+    {
+      badSum.evaluate(context);
+      FAIL() << "Adding a string to a product worked.";
+    }
+   catch (const Backwards::Types::TypedOperationException& e)
+    {
+      EXPECT_EQ(0U, std::string(e.what()).find("Error adding"));
+    }
+ }
+
 TEST(EngineTests, testFinalConst)
  {
    std::shared_ptr<Forwards::Types::ValueType> res;
@@ -1147,11 +1216,11 @@ TEST(EngineTests, testFinalConst)
    shet.sheet[1].resize(3);
    shet.sheet[2].resize(3);
 
-   shet.sheet[0][0] = std::make_unique<Forwards::Engine::Cell>();
-   shet.sheet[1][1] = std::make_unique<Forwards::Engine::Cell>();
-   shet.sheet[1][1]->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("6"));
+   shet.initCellAt(0U, 0U);
+   shet.initCellAt(1U, 1U);
+   shet.getCellAt(1U, 1U)->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("6"));
 
-   Forwards::Engine::CellFrame frame (shet.sheet[0][0].get(), 0U, 0U);
+   Forwards::Engine::CellFrame frame (shet.getCellAt(0U, 0U), 0U, 0U);
    context.pushCell(&frame);
 
    std::shared_ptr<Forwards::Engine::Constant> A1 = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), std::make_shared<Forwards::Types::CellRefValue>(false, 1, false, 1));
@@ -1202,18 +1271,18 @@ TEST(EngineTests, testFinalConst)
    res = B4->evaluate(context);
    ASSERT_TRUE(typeid(Forwards::Types::NilValue) == typeid(*res.get()));
 
-   shet.sheet[1][1]->previousValue.reset();
-   shet.sheet[1][1]->inEvaluation = true;
+   shet.getCellAt(1U, 1U)->previousValue.reset();
+   shet.getCellAt(1U, 1U)->inEvaluation = true;
    res = A1->evaluate(context);
    ASSERT_TRUE(typeid(Forwards::Types::NilValue) == typeid(*res.get()));
 
-   shet.sheet[1][1]->previousValue = makeFloatValue("9");
+   shet.getCellAt(1U, 1U)->previousValue = makeFloatValue("9");
    res = A1->evaluate(context);
    ASSERT_TRUE(typeid(Forwards::Types::FloatValue) == typeid(*res.get()));
    EXPECT_EQ(BigInt::Fixed("9"), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(res)->value);
 
-   shet.sheet[1][1]->inEvaluation = false;
-   shet.sheet[1][1]->previousGeneration = context.generation;
+   shet.getCellAt(1U, 1U)->inEvaluation = false;
+   shet.getCellAt(1U, 1U)->previousGeneration = context.generation;
    res = A1->evaluate(context);
    ASSERT_TRUE(typeid(Forwards::Types::FloatValue) == typeid(*res.get()));
    EXPECT_EQ(BigInt::Fixed("9"), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(res)->value);
@@ -1225,8 +1294,8 @@ TEST(EngineTests, testFinalConst)
    EXPECT_EQ(BigInt::Fixed("6"), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(res)->value);
 
       // Ensure that a cell that references a cell doesn't return a cell reference.
-   shet.sheet[0][2] = std::make_unique<Forwards::Engine::Cell>();
-   shet.sheet[0][2]->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), std::make_shared<Forwards::Types::CellRefValue>(true, 1, true, 1));
+   shet.initCellAt(0U, 2U);
+   shet.getCellAt(0U, 2U)->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), std::make_shared<Forwards::Types::CellRefValue>(true, 1, true, 1));
    std::shared_ptr<Forwards::Engine::Constant> A9 = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), std::make_shared<Forwards::Types::CellRefValue>(true, 0, true, 2));
    res = A9->evaluate(context);
    ASSERT_TRUE(typeid(Forwards::Types::FloatValue) == typeid(*res.get()));
@@ -1235,8 +1304,8 @@ TEST(EngineTests, testFinalConst)
    std::shared_ptr<Forwards::Engine::Constant> one = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("6"));
    std::shared_ptr<Forwards::Engine::Constant> two = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), std::make_shared<Forwards::Types::StringValue>("U"));
    std::shared_ptr<Forwards::Engine::Plus> plus = std::make_shared<Forwards::Engine::Plus>(Forwards::Input::Token(), one, two);
-   shet.sheet[1][2] = std::make_unique<Forwards::Engine::Cell>();
-   shet.sheet[1][2]->value = plus;
+   shet.initCellAt(1U, 2U);
+   shet.getCellAt(1U, 2U)->value = plus;
    std::shared_ptr<Forwards::Engine::Constant> F9 = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), std::make_shared<Forwards::Types::CellRefValue>(true, 1, true, 2));
    EXPECT_THROW(F9->evaluate(context), Backwards::Types::TypedOperationException);
  }
@@ -1256,26 +1325,26 @@ TEST(EngineTests, testFunctionsAndRanges)
    shet.sheet[1].resize(3);
    shet.sheet[2].resize(3);
 
-   shet.sheet[0][0] = std::make_unique<Forwards::Engine::Cell>();
-   shet.sheet[0][1] = std::make_unique<Forwards::Engine::Cell>();
-   shet.sheet[0][2] = std::make_unique<Forwards::Engine::Cell>();
-   shet.sheet[1][0] = std::make_unique<Forwards::Engine::Cell>();
-   shet.sheet[1][1] = std::make_unique<Forwards::Engine::Cell>();
-   shet.sheet[1][2] = std::make_unique<Forwards::Engine::Cell>();
-   shet.sheet[2][0] = std::make_unique<Forwards::Engine::Cell>();
-   shet.sheet[2][1] = std::make_unique<Forwards::Engine::Cell>();
-   shet.sheet[2][2] = std::make_unique<Forwards::Engine::Cell>();
-   shet.sheet[0][0]->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("1"));
-   shet.sheet[0][1]->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("2"));
-   shet.sheet[0][2]->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("3"));
-   shet.sheet[1][0]->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("4"));
-   shet.sheet[1][1]->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("5"));
-   shet.sheet[1][2]->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("6"));
-   shet.sheet[2][0]->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("7"));
-   shet.sheet[2][1]->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("8"));
-   shet.sheet[2][2]->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("9"));
-
-   Forwards::Engine::CellFrame frame (shet.sheet[0][0].get(), 0U, 0U);
+   shet.initCellAt(0U, 0U);
+   shet.initCellAt(0U, 1U);
+   shet.initCellAt(0U, 2U);
+   shet.initCellAt(1U, 0U);
+   shet.initCellAt(1U, 1U);
+   shet.initCellAt(1U, 2U);
+   shet.initCellAt(2U, 0U);
+   shet.initCellAt(2U, 1U);
+   shet.initCellAt(2U, 2U);
+   shet.getCellAt(0U, 0U)->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("1"));
+   shet.getCellAt(0U, 1U)->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("2"));
+   shet.getCellAt(0U, 2U)->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("3"));
+   shet.getCellAt(1U, 0U)->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("4"));
+   shet.getCellAt(1U, 1U)->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("5"));
+   shet.getCellAt(1U, 2U)->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("6"));
+   shet.getCellAt(2U, 0U)->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("7"));
+   shet.getCellAt(2U, 1U)->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("8"));
+   shet.getCellAt(2U, 2U)->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("9"));
+
+   Forwards::Engine::CellFrame frame (shet.getCellAt(0U, 0U), 0U, 0U);
    EXPECT_EQ(nullptr, context.topCell());
    context.pushCell(&frame);
 
@@ -1416,6 +1485,151 @@ TEST(EngineTests, testFunctionsAndRanges)
    EXPECT_EQ("@ARG(6+9)", funTestParens->toString(0U, 0U, 5));
  }
 
+TEST(EngineTests, testAggregates)
+ {
+   Forwards::Engine::CallingContext context;
+   StringLogger logger;
+   context.logger = &logger;
+
+   Forwards::Engine::SpreadSheet shet;
+   context.theSheet = &shet;
+
+   shet.sheet.resize(4U);
+   shet.sheet[0].resize(4);
+   shet.sheet[1].resize(4);
+   shet.sheet[2].resize(4);
+   shet.sheet[3].resize(4);
+
+      // A: 1.5, "x", empty, 2.25; B: 7, 7.00, empty, -3; C: the range A1:B4; D1 holds the sum.
+   shet.initCellAt(0U, 0U);
+   shet.initCellAt(0U, 1U);
+   shet.initCellAt(0U, 3U);
+   shet.initCellAt(1U, 0U);
+   shet.initCellAt(1U, 1U);
+   shet.initCellAt(1U, 3U);
+   shet.initCellAt(2U, 0U);
+   shet.initCellAt(3U, 0U);
+   shet.getCellAt(0U, 0U)->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("1.5"));
+   shet.getCellAt(0U, 1U)->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), std::make_shared<Forwards::Types::StringValue>("x"));
+   shet.getCellAt(0U, 3U)->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("2.25"));
+   shet.getCellAt(1U, 0U)->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("7"));
+   shet.getCellAt(1U, 1U)->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("7.00"));
+   shet.getCellAt(1U, 3U)->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("-3"));
+   shet.getCellAt(2U, 0U)->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), std::make_shared<Forwards::Types::CellRangeValue>(0, 0, 1, 3));
+   shet.getCellAt(3U, 0U)->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("0"));
+
+   Forwards::Engine::CellFrame frame (shet.getCellAt(3U, 0U), 3U, 0U);
+   context.pushCell(&frame);
+
+   Forwards::Engine::GetterMap map;
+
+   Backwards::Engine::Scope global;
+   context.globalScope = &global;
+   Forwards::Parser::ContextBuilder::createGlobalScope(global);
+   Backwards::Parser::GetterSetter gs;
+   Backwards::Parser::SymbolTable table (gs, global);
+   Backwards::Input::FileInput console ("../Tests/StdLib.txt");
+   Backwards::Input::Lexer lexer (console, "StdLib.txt");
+
+   std::shared_ptr<Backwards::Engine::Statement> stdLib = Backwards::Parser::Parser::ParseFunctions(lexer, table, logger);
+   stdLib->execute(context);
+
+      // The scripts that the builtins replaced: the builtins must agree with them, scale and all.
+   Backwards::Input::StringInput scripts (
+      "set OLDMAX to function (x) is set result to 'Empty' set found to 0 for item in x do set temp to item "
+         "if IsCellRef(item) then set temp to EvalCell(item) end "
+         "if IsFloat(temp) then if found then set result to Max(result; temp) else set result to temp set found to 1 end "
+         "elseif IsCellRange(temp) then set temp to OLDMAX(temp) if !IsString(temp) then "
+            "if found then set result to Max(result; temp) else set result to temp set found to 1 end end end end "
+         "return result end "
+      "set OLDMIN to function (x) is set result to 'Empty' set found to 0 for item in x do set temp to item "
+         "if IsCellRef(item) then set temp to EvalCell(item) end "
+         "if IsFloat(temp) then if found then set result to Min(result; temp) else set result to temp set found to 1 end "
+         "elseif IsCellRange(temp) then set temp to OLDMIN(temp) if !IsString(temp) then "
+            "if found then set result to Min(result; temp) else set result to temp set found to 1 end end end end "
+         "return result end "
+      "set OLDSUM to function (x) is set result to 0 for item in x do set temp to item "
+         "if IsCellRef(item) then set temp to EvalCell(item) end "
+         "if IsFloat(temp) then set result to result + temp elseif IsCellRange(temp) then set result to result + OLDSUM(temp) end end "
+         "return result end "
+      "set OLDCOUNT to function (x) is set result to 0 for item in x do set temp to item "
+         "if IsCellRef(item) then set temp to EvalCell(item) end "
+         "if IsFloat(temp) then set result to result + 1 elseif IsCellRange(temp) then set result to result + OLDCOUNT(temp) end end "
+         "return result end "
+      "set OLDAVERAGE to function (x) is return OLDSUM(x) / OLDCOUNT(x) end");
+   Backwards::Input::Lexer lexer2 (scripts, "OldLibrary");
+
+   std::shared_ptr<Backwards::Engine::Statement> stdLib2 = Backwards::Parser::Parser::ParseFunctions(lexer2, table, logger);
+   stdLib2->execute(context);
+
+   for (const std::string& name : global.names)
+    {
+      std::string temp = name;
+      std::transform(temp.begin(), temp.end(), temp.begin(), [](unsigned char c){ return std::toupper(c); });
+      if (name == temp)
+       {
+         map.insert(std::make_pair(name, table.getVariableGetter(name)));
+       }
+    }
+
+   const auto call = [&](const std::string& name, const std::vector<std::shared_ptr<Forwards::Engine::Expression> >& args)
+    {
+      ++context.generation; // Each call recomputes the cells.
+      Forwards::Engine::FunctionCall fun (Forwards::Input::Token(Forwards::Input::IDENTIFIER, name, 1U),
+         std::make_shared<Backwards::Engine::Variable>(Backwards::Input::Token(), map[name]), args);
+      return fun.evaluate(context);
+    };
+
+   std::vector<std::vector<std::shared_ptr<Forwards::Engine::Expression> > > argLists (4U);
+   argLists[0].emplace_back(std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), std::make_shared<Forwards::Types::CellRangeValue>(0, 0, 1, 3)));
+   argLists[1].emplace_back(std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), std::make_shared<Forwards::Types::CellRangeValue>(0, 0, 2, 0)));
+   argLists[1].emplace_back(std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue("5.125")));
+   argLists[1].emplace_back(std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), std::make_shared<Forwards::Types::StringValue>("Hi")));
+   argLists[2].emplace_back(std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), std::make_shared<Forwards::Types::CellRangeValue>(0, 2, 0, 2)));
+   argLists[3].emplace_back(std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), std::make_shared<Forwards::Types::CellRangeValue>(1, 0, 1, 1)));
+
+   for (const std::string& name : std::vector<std::string>({ "SUM", "COUNT", "MAX", "MIN", "AVERAGE" }))
+    {
+      for (size_t i = 0U; i < argLists.size(); ++i)
+       {
+         if (("AVERAGE" == name) && (2U == i))
+          {
+            continue; // Zero divided by zero.
+          }
+         std::shared_ptr<Forwards::Types::ValueType> lhs = call(name, argLists[i]);
+         std::shared_ptr<Forwards::Types::ValueType> rhs = call("OLD" + name, argLists[i]);
+         ASSERT_TRUE(typeid(*lhs.get()) == typeid(*rhs.get())) << name << " " << i;
+         if (typeid(Forwards::Types::FloatValue) == typeid(*lhs.get()))
+          {
+            const BigInt::Fixed& left = std::dynamic_pointer_cast<Forwards::Types::FloatValue>(lhs)->value;
+            const BigInt::Fixed& right = std::dynamic_pointer_cast<Forwards::Types::FloatValue>(rhs)->value;
+            EXPECT_EQ(right, left) << name << " " << i;
+            EXPECT_EQ(right.getPrecision(), left.getPrecision()) << name << " " << i;
+          }
+         else
+          {
+            EXPECT_EQ(std::dynamic_pointer_cast<Forwards::Types::StringValue>(rhs)->value, std::dynamic_pointer_cast<Forwards::Types::StringValue>(lhs)->value) << name << " " << i;
+          }
+       }
+    }
+
+   std::shared_ptr<Forwards::Types::ValueType> res = call("SUM", argLists[1]);
+   ASSERT_TRUE(typeid(Forwards::Types::FloatValue) == typeid(*res.get()));
+   EXPECT_EQ(BigInt::Fixed("28.375"), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(res)->value);
+   EXPECT_EQ(3U, std::dynamic_pointer_cast<Forwards::Types::FloatValue>(res)->value.getPrecision());
+
+   res = call("MAX", argLists[3]); // The first of equals wins.
+   ASSERT_TRUE(typeid(Forwards::Types::FloatValue) == typeid(*res.get()));
+   EXPECT_EQ(0U, std::dynamic_pointer_cast<Forwards::Types::FloatValue>(res)->value.getPrecision());
+
+   res = call("MIN", argLists[2]);
+   ASSERT_TRUE(typeid(Forwards::Types::StringValue) == typeid(*res.get()));
+   EXPECT_EQ("Empty", std::dynamic_pointer_cast<Forwards::Types::StringValue>(res)->value);
+
+   std::shared_ptr<Backwards::Types::ValueType> notArray = std::make_shared<Backwards::Types::FloatValue>(BigInt::Fixed("1"));
+   EXPECT_THROW(Forwards::Engine::CellSum(context, notArray), Backwards::Types::TypedOperationException);
+ }
+
 TEST(EngineTests, testCellRangeExpand)
  {
    Backwards::Types::CellRangeValue defaulted (std::make_shared<Forwards::Engine::CellRangeExpand>());
@@ -1503,6 +1717,55 @@ TEST(EngineTests, testCellRangeExpand)
    EXPECT_THROW(also2.getIndex(7U), Backwards::Engine::ProgrammingException);
  }
 
+TEST(EngineTests, testCellRangeCursor)
+ {
+   Backwards::Types::CellRangeValue column (std::make_shared<Forwards::Engine::CellRangeExpand>(std::make_shared<Forwards::Types::CellRangeValue>(3U, 4U, 3U, 6U)));
+   Backwards::Types::CellRangeValue square (std::make_shared<Forwards::Engine::CellRangeExpand>(std::make_shared<Forwards::Types::CellRangeValue>(2U, 3U, 4U, 5U)));
+
+   const auto cellOf = [](const std::shared_ptr<Backwards::Types::ValueType>& res)
+    {
+      std::shared_ptr<Forwards::Engine::CellRefEval> eval = std::dynamic_pointer_cast<Forwards::Engine::CellRefEval>(std::dynamic_pointer_cast<Backwards::Types::CellRefValue>(res)->value);
+      return std::dynamic_pointer_cast<Forwards::Types::CellRefValue>(std::dynamic_pointer_cast<Forwards::Engine::Constant>(eval->value)->value);
+    };
+
+      // Nothing else holds an element: it is reused.
+   std::unique_ptr<Backwards::Types::CellRangeCursor> cursor = column.getCursor();
+   ASSERT_TRUE(cursor->hasNext());
+   const Backwards::Types::ValueType* first = cursor->next().get();
+   ASSERT_TRUE(cursor->hasNext());
+   std::shared_ptr<Backwards::Types::ValueType> res = cursor->next();
+   EXPECT_EQ(first, res.get());
+   EXPECT_EQ(3, cellOf(res)->colRef);
+   EXPECT_EQ(5, cellOf(res)->rowRef);
+
+      // Something holds the element: the next one is new, and the held one is unchanged.
+   ASSERT_TRUE(cursor->hasNext());
+   std::shared_ptr<Backwards::Types::ValueType> next = cursor->next();
+   EXPECT_NE(res.get(), next.get());
+   EXPECT_EQ(5, cellOf(res)->rowRef);
+   EXPECT_EQ(6, cellOf(next)->rowRef);
+   EXPECT_FALSE(cursor->hasNext());
+
+      // The same goes for the parts of an element.
+   cursor = square.getCursor();
+   res = cursor->next();
+   std::shared_ptr<Forwards::Engine::CellRangeExpand> part = std::dynamic_pointer_cast<Forwards::Engine::CellRangeExpand>(std::dynamic_pointer_cast<Backwards::Types::CellRangeValue>(res)->value);
+   const Backwards::Types::ValueType* held = res.get();
+   res.reset();
+   next = cursor->next();
+   EXPECT_NE(held, next.get());
+   EXPECT_EQ(2U, part->value->col1);
+   part.reset();
+   next.reset();
+   res = cursor->next();
+   part = std::dynamic_pointer_cast<Forwards::Engine::CellRangeExpand>(std::dynamic_pointer_cast<Backwards::Types::CellRangeValue>(res)->value);
+   EXPECT_EQ(4U, part->value->col1);
+   EXPECT_EQ(4U, part->value->col2);
+   EXPECT_EQ(3U, part->value->row1);
+   EXPECT_EQ(5U, part->value->row2);
+   EXPECT_FALSE(cursor->hasNext());
+ }
+
 TEST(EngineTests, testCellRefEval)
  {
    Backwards::Types::CellRefValue defaulted (std::make_shared<Forwards::Engine::CellRefEval>());
@@ -1593,9 +1856,9 @@ TEST(EngineTests, testCellEval)
    shet.sheet.resize(1U);
    shet.sheet[0].resize(1U);
 
-   shet.sheet[0][0] = std::make_unique<Forwards::Engine::Cell>();
+   shet.initCellAt(0U, 0U);
 
-   Forwards::Engine::CellFrame frame (shet.sheet[0][0].get(), 0U, 0U);
+   Forwards::Engine::CellFrame frame (shet.getCellAt(0U, 0U), 0U, 0U);
    EXPECT_EQ(nullptr, context.topCell());
    context.pushCell(&frame);
 
@@ -119,11 +119,10 @@ int main (int argc, char ** argv)
     }
 
    Forwards::Engine::SpreadSheet theSheet;
-   theSheet.sheet.emplace_back(std::vector<std::unique_ptr<Forwards::Engine::Cell> >());
-   theSheet.sheet[0].emplace_back(std::make_unique<Forwards::Engine::Cell>());
+   theSheet.initCellAt(0U, 0U);
    context.theSheet = &theSheet;
 
-   Forwards::Engine::CellFrame frame (theSheet.sheet[0][0].get(), 0U, 0U);
+   Forwards::Engine::CellFrame frame (theSheet.getCellAt(0U, 0U), 0U, 0U);
    context.pushCell(&frame);
 
    std::string inLine;
@@ -36,6 +36,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Forwards/Engine/SpreadSheet.h"
 #include "Forwards/Engine/Cell.h"
 
+#include "Forwards/Parser/ContextBuilder.h"
 #include "Forwards/Parser/StringLogger.h"
 
 #include "Forwards/Types/FloatValue.h"
@@ -1056,3 +1057,626 @@ TEST(EngineTests, testSpreadSheet_TestInsertRowCol)
    ASSERT_EQ(2U, shet.sheet[1].size());
    ASSERT_EQ(2U, shet.max_row);
  }
+
+static void setCell(Forwards::Engine::SpreadSheet& shet, size_t col, size_t row, const std::string& input)
+ {
+   if (nullptr == shet.getCellAt(col, row))
+    {
+      shet.initCellAt(col, row);
+    }
+   Forwards::Engine::Cell* cell = shet.getCellAt(col, row);
+   cell->type = Forwards::Engine::VALUE;
+   cell->currentInput = input;
+   cell->value.reset();
+   shet.markDirty(col, row);
+ }
+
+TEST(EngineTests, testSpreadSheet_Update)
+ {
+   Forwards::Engine::CallingContext context;
+   Forwards::Engine::SpreadSheet shet;
+   context.theSheet = &shet;
+   Forwards::Engine::NameMap names;
+   context.names = &names;
+   Forwards::Engine::GetterMap map;
+   context.map = &map;
+
+   setCell(shet, 0U, 0U, "1");
+   setCell(shet, 0U, 1U, "A1+1");
+   setCell(shet, 0U, 2U, "A2*2");
+   setCell(shet, 1U, 0U, "7");
+   setCell(shet, 1U, 1U, "B1+1");
+
+   shet.update(context); // The first update is a full recalc.
+
+   ASSERT_TRUE(typeid(Forwards::Types::FloatValue) == typeid(*shet.getCellAt(0U, 2U)->previousValue.get()));
+   EXPECT_EQ(BigInt::Fixed("4"), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(0U, 2U)->previousValue)->value);
+   std::shared_ptr<Forwards::Types::ValueType> b2 = shet.getCellAt(1U, 1U)->previousValue;
+
+      // Only the dependents of A1 are recomputed.
+   setCell(shet, 0U, 0U, "5");
+   shet.update(context);
+
+   ASSERT_TRUE(typeid(Forwards::Types::FloatValue) == typeid(*shet.getCellAt(0U, 2U)->previousValue.get()));
+   EXPECT_EQ(BigInt::Fixed("12"), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(0U, 2U)->previousValue)->value);
+   EXPECT_EQ(b2.get(), shet.getCellAt(1U, 1U)->previousValue.get());
+
+      // A2 doesn't change, so A3 isn't recomputed.
+   std::shared_ptr<Forwards::Types::ValueType> a2 = shet.getCellAt(0U, 1U)->previousValue;
+   std::shared_ptr<Forwards::Types::ValueType> a3 = shet.getCellAt(0U, 2U)->previousValue;
+   setCell(shet, 0U, 1U, "A1+A1-4");
+   shet.update(context);
+
+   EXPECT_NE(a2.get(), shet.getCellAt(0U, 1U)->previousValue.get());
+   EXPECT_EQ(a3.get(), shet.getCellAt(0U, 2U)->previousValue.get());
+
+      // Filling in an empty cell that was referenced updates the referer.
+   setCell(shet, 2U, 0U, "D1");
+   shet.update(context);
+   EXPECT_TRUE(typeid(Forwards::Types::NilValue) == typeid(*shet.getCellAt(2U, 0U)->previousValue.get()));
+
+   setCell(shet, 3U, 0U, "3");
+   shet.update(context);
+   ASSERT_TRUE(typeid(Forwards::Types::FloatValue) == typeid(*shet.getCellAt(2U, 0U)->previousValue.get()));
+   EXPECT_EQ(BigInt::Fixed("3"), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(2U, 0U)->previousValue)->value);
+
+      // Clearing a cell updates the referer, too.
+   shet.clearCellAt(3U, 0U);
+   shet.update(context);
+   EXPECT_TRUE(typeid(Forwards::Types::NilValue) == typeid(*shet.getCellAt(2U, 0U)->previousValue.get()));
+ }
+
+TEST(EngineTests, testSpreadSheet_UpdateRanges)
+ {
+   Forwards::Engine::CallingContext context;
+   Forwards::Engine::SpreadSheet shet;
+   context.theSheet = &shet;
+   Forwards::Engine::NameMap names;
+   context.names = &names;
+   Forwards::Engine::GetterMap map;
+   context.map = &map;
+   Forwards::Parser::StringLogger logger;
+   context.logger = &logger;
+
+   Backwards::Engine::Scope global;
+   context.globalScope = &global;
+   Forwards::Parser::ContextBuilder::createGlobalScope(global); // Create the global scope before the table.
+   Backwards::Parser::GetterSetter gs;
+   Backwards::Parser::SymbolTable table (gs, global);
+   Backwards::Input::StringInput library ("set SUM to CellSum");
+   Backwards::Input::Lexer lexer (library, "SUM");
+   std::shared_ptr<Backwards::Engine::Statement> stdLib = Backwards::Parser::Parser::ParseFunctions(lexer, table, logger);
+   ASSERT_NE(nullptr, stdLib.get());
+   stdLib->execute(context);
+   map.insert(std::make_pair("SUM", table.getVariableGetter("SUM")));
+
+      // Column A holds the numbers. Column B sums overlapping ranges of them, of every size and alignment.
+   const size_t rows = 40U;
+   for (size_t row = 0U; row < rows; ++row)
+    {
+      setCell(shet, 0U, row, "1");
+    }
+   for (size_t row = 0U; row < rows; ++row)
+    {
+      setCell(shet, 1U, row, "@SUM(A" + std::to_string(row / 3U + 1U) + ":A" + std::to_string(row + 1U) + ")");
+    }
+   setCell(shet, 2U, 0U, "@SUM(A3:A20;A30:A42)");
+   shet.update(context);
+
+   for (size_t edit = 0U; edit < rows + 4U; ++edit) // Past the end, too: filling in a cell that was in a range.
+    {
+      std::vector<std::shared_ptr<Forwards::Types::ValueType> > before;
+      for (size_t row = 0U; row < rows; ++row)
+       {
+         before.push_back(shet.getCellAt(1U, row)->previousValue);
+       }
+      std::shared_ptr<Forwards::Types::ValueType> c1 = shet.getCellAt(2U, 0U)->previousValue;
+      setCell(shet, 0U, edit, "2");
+      shet.update(context);
+
+         // A sum is recomputed exactly when its range covers the edit.
+      for (size_t row = 0U; row < rows; ++row)
+       {
+         const size_t first = row / 3U;
+         const bool covers = (edit >= first) && (edit <= row);
+         const std::shared_ptr<Forwards::Types::ValueType> after = shet.getCellAt(1U, row)->previousValue;
+         ASSERT_TRUE(typeid(Forwards::Types::FloatValue) == typeid(*after.get()));
+         size_t expected = 0U;
+         for (size_t i = first; i <= row; ++i)
+          {
+            expected += (i <= edit) ? 2U : 1U;
+          }
+         EXPECT_EQ(BigInt::Fixed(std::to_string(expected)), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(after)->value);
+         EXPECT_EQ(covers, before[row].get() != after.get());
+       }
+      const bool coversC1 = ((edit >= 2U) && (edit <= 19U)) || ((edit >= 29U) && (edit <= 41U));
+      EXPECT_EQ(coversC1, c1.get() != shet.getCellAt(2U, 0U)->previousValue.get());
+    }
+ }
+
+static void buildParallelSheet(Forwards::Engine::SpreadSheet& shet)
+ {
+   setCell(shet, 0U, 0U, "2");
+   for (size_t col = 1U; col < 8U; ++col)
+    {
+      setCell(shet, col, 0U, "$A$1*" + std::to_string(col));
+      for (size_t row = 1U; row < 40U; ++row)
+       {
+         const std::string up = std::string(1U, static_cast<char>('A' + col)) + std::to_string(row);
+         const std::string left = std::string(1U, static_cast<char>('A' + col - 1U)) + std::to_string(row + 1U);
+         setCell(shet, col, row, up + "+$A$1+" + left);
+       }
+    }
+ }
+
+TEST(EngineTests, testSpreadSheet_Recalc_Parallel)
+ {
+   Forwards::Engine::NameMap names;
+   Forwards::Engine::GetterMap map;
+
+   Forwards::Engine::CallingContext context1;
+   Forwards::Engine::SpreadSheet shet1;
+   context1.theSheet = &shet1;
+   context1.names = &names;
+   context1.map = &map;
+   buildParallelSheet(shet1);
+   shet1.recalc(context1);
+
+   Forwards::Engine::CallingContext context4;
+   Forwards::Engine::SpreadSheet shet4;
+   context4.theSheet = &shet4;
+   context4.names = &names;
+   context4.map = &map;
+   shet4.threads = 4U;
+   buildParallelSheet(shet4);
+   shet4.recalc(context4);
+
+   for (size_t col = 0U; col < 8U; ++col)
+    {
+      for (size_t row = 0U; row < shet1.sheet[col].size(); ++row)
+       {
+         ASSERT_TRUE(typeid(Forwards::Types::FloatValue) == typeid(*shet4.getCellAt(col, row)->previousValue.get()));
+         EXPECT_EQ(std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet1.getCellAt(col, row)->previousValue)->value,
+            std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet4.getCellAt(col, row)->previousValue)->value);
+       }
+    }
+
+      // The recorded references are the same, too.
+   setCell(shet4, 0U, 0U, "3");
+   shet4.update(context4);
+   setCell(shet1, 0U, 0U, "3");
+   shet1.recalc(context1);
+   EXPECT_EQ(std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet1.getCellAt(7U, 39U)->previousValue)->value,
+      std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet4.getCellAt(7U, 39U)->previousValue)->value);
+ }
+
+TEST(EngineTests, testSpreadSheet_Recalc_ParallelRecursion) // Falls back to evaluating in order, as in testSpreadSheet_Recalc_TBLR.
+ {
+   Forwards::Engine::CallingContext context;
+   Forwards::Engine::SpreadSheet shet;
+   context.theSheet = &shet;
+   Forwards::Engine::NameMap names;
+   context.names = &names;
+   Forwards::Engine::GetterMap map;
+   context.map = &map;
+   shet.threads = 4U;
+
+   setCell(shet, 0U, 0U, "B2");
+   shet.getCellAt(0U, 0U)->previousValue = makeFloatValue("2");
+   setCell(shet, 1U, 1U, "A1");
+   shet.getCellAt(1U, 1U)->previousValue = makeFloatValue("3");
+
+   shet.recalc(context);
+
+   Forwards::Engine::Cell* cell = shet.getCellAt(0U, 0U);
+   ASSERT_TRUE(typeid(Forwards::Types::FloatValue) == typeid(*cell->previousValue.get()));
+   EXPECT_EQ(BigInt::Fixed("2"), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(cell->previousValue)->value);
+   cell = shet.getCellAt(1U, 1U);
+   ASSERT_TRUE(typeid(Forwards::Types::FloatValue) == typeid(*cell->previousValue.get()));
+   EXPECT_EQ(BigInt::Fixed("2"), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(cell->previousValue)->value);
+ }
+
+TEST(EngineTests, testSpreadSheet_Recalc_ParallelGlobals) // A library function that sets a global makes the recalc go in order.
+ {
+   Forwards::Engine::CallingContext context;
+   Forwards::Parser::StringLogger logger;
+   context.logger = &logger;
+   Forwards::Engine::SpreadSheet shet;
+   context.theSheet = &shet;
+   Forwards::Engine::NameMap names;
+   context.names = &names;
+   Forwards::Engine::GetterMap map;
+   context.map = &map;
+   shet.threads = 4U;
+
+   Backwards::Engine::Scope global;
+   context.globalScope = &global;
+   Backwards::Parser::ContextBuilder::createGlobalScope(global); // Create the global scope before the table.
+   Backwards::Parser::GetterSetter gs;
+   Backwards::Parser::SymbolTable table (gs, global);
+
+   Backwards::Input::StringInput library ("set counter to 0 set BUMP to function (x) is set counter to counter + 1 return counter end");
+   Backwards::Input::Lexer lexer (library, "BUMP");
+   std::shared_ptr<Backwards::Engine::Statement> stdLib = Backwards::Parser::Parser::ParseFunctions(lexer, table, logger);
+   ASSERT_NE(nullptr, stdLib.get());
+   stdLib->execute(context);
+   map.insert(std::make_pair("BUMP", table.getVariableGetter("BUMP")));
+
+   const size_t rows = 500U;
+   for (size_t col = 0U; col < 8U; ++col)
+    {
+      for (size_t row = 0U; row < rows; ++row)
+       {
+         setCell(shet, col, row, "@BUMP(1)");
+       }
+    }
+
+   shet.recalc(context);
+
+      // Each cell got the next count, in the order the sheet is evaluated in.
+   for (size_t col = 0U; col < 8U; ++col)
+    {
+      for (size_t row = 0U; row < rows; ++row)
+       {
+         Forwards::Engine::Cell* cell = shet.getCellAt(col, row);
+         ASSERT_TRUE(typeid(Forwards::Types::FloatValue) == typeid(*cell->previousValue.get()));
+         EXPECT_EQ(BigInt::Fixed(std::to_string(col * rows + row + 1U)), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(cell->previousValue)->value);
+       }
+    }
+ }
+
+TEST(EngineTests, testSpreadSheet_Recalc_LongChain) // This would overflow the stack if each link were evaluated on it.
+ {
+   Forwards::Engine::CallingContext context;
+   Forwards::Engine::SpreadSheet shet;
+   context.theSheet = &shet;
+   Forwards::Engine::NameMap names;
+   context.names = &names;
+   Forwards::Engine::GetterMap map;
+   context.map = &map;
+
+   const size_t length = 200000U;
+   for (size_t row = 0U; row < length - 1U; ++row)
+    {
+      setCell(shet, 1U, row, "B" + std::to_string(row + 2U) + "+1");
+    }
+   setCell(shet, 1U, length - 1U, "1");
+
+      // And a circular reference that would overflow the stack, too.
+   for (size_t row = 0U; row < length; ++row)
+    {
+      setCell(shet, 3U, row, "D" + std::to_string((row + 1U) % length + 1U));
+    }
+
+   shet.recalc(context);
+
+   Forwards::Engine::Cell* cell = shet.getCellAt(1U, 0U);
+   ASSERT_TRUE(typeid(Forwards::Types::FloatValue) == typeid(*cell->previousValue.get()));
+   EXPECT_EQ(BigInt::Fixed(std::to_string(length)), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(cell->previousValue)->value);
+   size_t recursed = 0U;
+   for (size_t row = 0U; row < length; ++row)
+    {
+      EXPECT_EQ(context.generation - 1U, shet.getCellAt(3U, row)->previousGeneration);
+      EXPECT_FALSE(shet.getCellAt(3U, row)->inEvaluation);
+      EXPECT_FALSE(shet.getCellAt(3U, row)->waiting);
+      if (true == shet.getCellAt(3U, row)->recursed) ++recursed;
+    }
+   EXPECT_TRUE(shet.getCellAt(3U, 0U)->recursed); // As on the stack: D1 was in evaluation when the loop came back to it.
+   EXPECT_EQ(1U, recursed);
+
+   setCell(shet, 1U, length - 1U, "2");
+   shet.update(context);
+
+   ASSERT_TRUE(typeid(Forwards::Types::FloatValue) == typeid(*cell->previousValue.get()));
+   EXPECT_EQ(BigInt::Fixed(std::to_string(length + 1U)), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(cell->previousValue)->value);
+ }
+
+TEST(EngineTests, testSpreadSheet_Sparse)
+ {
+   Forwards::Engine::CallingContext context;
+   Forwards::Engine::SpreadSheet shet;
+   context.theSheet = &shet;
+   Forwards::Engine::NameMap names;
+   context.names = &names;
+   Forwards::Engine::GetterMap map;
+   context.map = &map;
+
+   const size_t far = 50000000U;
+   setCell(shet, 0U, 63U, "1");
+   setCell(shet, 0U, 64U, "A64+1");
+   setCell(shet, 1U, far, "A65*2");
+   setCell(shet, 2U, 0U, "B50000001+1");
+
+   EXPECT_EQ(far + 1U, shet.sheet[1U].size());
+   EXPECT_EQ(1U, shet.sheet[1U].count());
+   EXPECT_EQ(far, shet.sheet[1U].next(0U));
+   EXPECT_EQ(far, shet.sheet[1U].previous(far + 1U));
+   EXPECT_TRUE(Forwards::Engine::Column::NONE == shet.sheet[1U].previous(far));
+   EXPECT_EQ(far + 1U, shet.max_row);
+
+   shet.c_major = false; // Row-major order has to skip the empty rows, too.
+   shet.recalc(context);
+   Forwards::Engine::Cell* cell = shet.getCellAt(2U, 0U);
+   ASSERT_TRUE(typeid(Forwards::Types::FloatValue) == typeid(*cell->previousValue.get()));
+   EXPECT_EQ(BigInt::Fixed("5"), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(cell->previousValue)->value);
+
+      // Moving cells across the edge of a block.
+   shet.insertRowBefore(10U);
+   EXPECT_TRUE(nullptr == shet.getCellAt(0U, 63U));
+   EXPECT_TRUE(nullptr != shet.getCellAt(0U, 64U));
+   EXPECT_TRUE(nullptr != shet.getCellAt(0U, 65U));
+   EXPECT_TRUE(nullptr != shet.getCellAt(1U, far + 1U));
+   EXPECT_EQ(far + 2U, shet.sheet[1U].size());
+   EXPECT_EQ(2U, shet.sheet[0U].count());
+
+   shet.removeRow(0U);
+   shet.removeRow(0U);
+   EXPECT_TRUE(nullptr != shet.getCellAt(0U, 62U));
+   EXPECT_TRUE(nullptr != shet.getCellAt(0U, 63U));
+   EXPECT_TRUE(nullptr == shet.getCellAt(0U, 64U));
+   EXPECT_TRUE(nullptr != shet.getCellAt(1U, far - 1U));
+   EXPECT_TRUE(nullptr == shet.getCellAt(2U, 0U));
+
+   shet.clearCellAt(1U, far - 1U);
+   EXPECT_EQ(0U, shet.sheet[1U].count());
+   EXPECT_EQ(far, shet.sheet[1U].size());
+   EXPECT_EQ(far, shet.sheet[1U].next(0U));
+ }
+
+TEST(EngineTests, testSpreadSheet_CellPool)
+ {
+   Forwards::Engine::SpreadSheet shet;
+
+   shet.initCellAt(0U, 0U);
+   Forwards::Engine::Cell* first = shet.getCellAt(0U, 0U);
+   first->shown().value = std::make_shared<Forwards::Types::StringValue>("shown");
+   first->shown().recursed = true;
+   shet.clearCellAt(0U, 0U);
+   shet.initCellAt(5U, 100U); // A freed cell is reused before anything new is allocated.
+   EXPECT_TRUE(first == shet.getCellAt(5U, 100U));
+   EXPECT_TRUE(Forwards::Engine::ERROR == shet.getCellAt(5U, 100U)->type);
+   EXPECT_EQ(0U, shet.getCellAt(5U, 100U)->previousGeneration);
+   EXPECT_TRUE(nullptr == shet.getCellAt(5U, 100U)->shown().value.get()); // Nor is what was shown for it.
+   EXPECT_FALSE(shet.getCellAt(5U, 100U)->shown().recursed);
+   EXPECT_TRUE(shet.getCellAt(5U, 100U)->currentInput.empty());
+
+   for (size_t row = 0U; row < 5000U; ++row) // Spans several slabs.
+    {
+      shet.initCellAt(1U, row);
+      shet.getCellAt(1U, row)->currentInput = std::to_string(row);
+    }
+   for (size_t row = 0U; row < 5000U; ++row)
+    {
+      EXPECT_EQ(std::to_string(row), shet.getCellAt(1U, row)->currentInput);
+    }
+
+      // Slabs are given back once their cells are all freed.
+   const size_t before = Forwards::Engine::Cell::slabs();
+    {
+      Forwards::Engine::SpreadSheet other;
+      for (size_t row = 0U; row < 100000U; ++row)
+       {
+         other.initCellAt(0U, row);
+       }
+      EXPECT_LT(before + 100U, Forwards::Engine::Cell::slabs());
+    }
+   EXPECT_GE(before + 1U, Forwards::Engine::Cell::slabs());
+ }
+
+TEST(EngineTests, testSpreadSheet_Cancel)
+ {
+   Forwards::Engine::CallingContext context;
+   Forwards::Engine::SpreadSheet shet;
+   context.theSheet = &shet;
+   Forwards::Engine::NameMap names;
+   context.names = &names;
+   Forwards::Engine::GetterMap map;
+   context.map = &map;
+
+   setCell(shet, 0U, 0U, "1");
+   setCell(shet, 0U, 1U, "A1+1");
+   setCell(shet, 0U, 2U, "A2*2");
+   setCell(shet, 1U, 0U, "7");
+   setCell(shet, 1U, 1U, "B1+1");
+
+      // A cancelled recalc evaluates nothing, and the next update evaluates it all.
+   shet.cancelled = true;
+   shet.update(context);
+   EXPECT_TRUE(nullptr == shet.getCellAt(0U, 2U)->previousValue.get());
+
+   shet.cancelled = false;
+   shet.update(context);
+   ASSERT_TRUE(typeid(Forwards::Types::FloatValue) == typeid(*shet.getCellAt(0U, 2U)->previousValue.get()));
+   EXPECT_EQ(BigInt::Fixed("4"), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(0U, 2U)->previousValue)->value);
+   EXPECT_EQ(5U, shet.progress);
+   EXPECT_EQ(5U, shet.progressTotal);
+
+      // A cancelled update keeps what it had left to do.
+   std::shared_ptr<Forwards::Types::ValueType> b2 = shet.getCellAt(1U, 1U)->previousValue;
+   setCell(shet, 0U, 0U, "5");
+   shet.cancelled = true;
+   shet.update(context);
+   EXPECT_EQ(BigInt::Fixed("4"), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(0U, 2U)->previousValue)->value);
+
+   shet.cancelled = false;
+   shet.update(context);
+   ASSERT_TRUE(typeid(Forwards::Types::FloatValue) == typeid(*shet.getCellAt(0U, 2U)->previousValue.get()));
+   EXPECT_EQ(BigInt::Fixed("12"), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(0U, 2U)->previousValue)->value);
+   EXPECT_EQ(b2.get(), shet.getCellAt(1U, 1U)->previousValue.get());
+ }
+
+class CancellingLogger final : public Backwards::Engine::Logger // Cancels the recalc the first time anything is logged.
+ {
+public:
+   explicit CancellingLogger(Forwards::Engine::SpreadSheet& sheet) : sheet(sheet), once(true) { }
+   Forwards::Engine::SpreadSheet& sheet;
+   bool once;
+   void log (const std::string&) { if (true == once) sheet.cancelled = true; once = false; }
+   std::string get () { return ""; }
+ };
+
+TEST(EngineTests, testSpreadSheet_CancelPartway)
+ {
+   Forwards::Engine::CallingContext context;
+   Forwards::Engine::SpreadSheet shet;
+   context.theSheet = &shet;
+   Forwards::Engine::NameMap names;
+   context.names = &names;
+   Forwards::Engine::GetterMap map;
+   context.map = &map;
+   CancellingLogger logger (shet);
+   context.logger = &logger;
+
+   Backwards::Engine::Scope global;
+   context.globalScope = &global;
+   Backwards::Parser::ContextBuilder::createGlobalScope(global); // Create the global scope before the table.
+   Backwards::Parser::GetterSetter gs;
+   Backwards::Parser::SymbolTable table (gs, global);
+   Backwards::Input::StringInput library ("set STOP to function (x) is call Info('stop') return 1 end");
+   Backwards::Input::Lexer lexer (library, "STOP");
+   std::shared_ptr<Backwards::Engine::Statement> stdLib = Backwards::Parser::Parser::ParseFunctions(lexer, table, logger);
+   ASSERT_NE(nullptr, stdLib.get());
+   stdLib->execute(context);
+   map.insert(std::make_pair("STOP", table.getVariableGetter("STOP")));
+
+      // A2 pulls in the whole chain down column B, and the recalc is cancelled halfway down it.
+   setCell(shet, 0U, 0U, "5");
+   setCell(shet, 0U, 1U, "B1");
+   for (size_t row = 0U; row < 199U; ++row)
+    {
+      setCell(shet, 1U, row, "B" + std::to_string(row + 2U) + "+1");
+    }
+   setCell(shet, 1U, 99U, "@STOP()+B101");
+   setCell(shet, 1U, 199U, "1");
+
+   shet.recalc(context);
+   ASSERT_TRUE(shet.cancelled);
+   std::shared_ptr<Forwards::Types::ValueType> a1 = shet.getCellAt(0U, 0U)->previousValue;
+   ASSERT_TRUE(nullptr != a1.get());
+   EXPECT_TRUE(nullptr == shet.getCellAt(0U, 1U)->previousValue.get());
+   EXPECT_TRUE(nullptr == shet.getCellAt(1U, 100U)->previousValue.get());
+   EXPECT_TRUE(nullptr == shet.getCellAt(1U, 150U)->previousValue.get());
+   EXPECT_TRUE(shet.progress < 5U);
+
+      // Edit while cancelled, then pick up where it stopped: what was finished isn't done again.
+   setCell(shet, 1U, 199U, "2");
+   shet.cancelled = false;
+   shet.update(context);
+   EXPECT_EQ(a1.get(), shet.getCellAt(0U, 0U)->previousValue.get());
+   ASSERT_TRUE(typeid(Forwards::Types::FloatValue) == typeid(*shet.getCellAt(0U, 1U)->previousValue.get()));
+   EXPECT_EQ(BigInt::Fixed("201"), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(0U, 1U)->previousValue)->value);
+   EXPECT_EQ(shet.progressTotal, shet.progress);
+   EXPECT_EQ(shet.getCellAt(0U, 1U)->previousValue.get(), shet.getCellAt(0U, 1U)->shown().value.get());
+
+      // And the references were recorded: an update only does what it has to.
+   setCell(shet, 1U, 199U, "3");
+   shet.update(context);
+   EXPECT_EQ(BigInt::Fixed("202"), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(0U, 1U)->previousValue)->value);
+   EXPECT_EQ(a1.get(), shet.getCellAt(0U, 0U)->previousValue.get());
+ }
+
+TEST(EngineTests, testSpreadSheet_Snapshot)
+ {
+   Forwards::Engine::CallingContext context;
+   Forwards::Engine::SpreadSheet shet;
+   context.theSheet = &shet;
+   Forwards::Engine::NameMap names;
+   context.names = &names;
+   Forwards::Engine::GetterMap map;
+   context.map = &map;
+
+   setCell(shet, 0U, 0U, "1");
+   setCell(shet, 0U, 1U, "A1+1");
+   setCell(shet, 1U, 0U, "B1");
+
+   shet.update(context);
+   EXPECT_EQ(shet.getCellAt(0U, 1U)->previousValue.get(), shet.getCellAt(0U, 1U)->shown().value.get());
+   EXPECT_TRUE(shet.getCellAt(1U, 0U)->shown().recursed);
+
+      // What is shown doesn't change until an update finishes.
+   std::shared_ptr<Forwards::Types::ValueType> a2 = shet.getCellAt(0U, 1U)->shown().value;
+   setCell(shet, 0U, 0U, "5");
+   shet.cancelled = true;
+   shet.update(context);
+   EXPECT_EQ(a2.get(), shet.getCellAt(0U, 1U)->shown().value.get());
+
+   shet.cancelled = false;
+   shet.update(context);
+   ASSERT_TRUE(typeid(Forwards::Types::FloatValue) == typeid(*shet.getCellAt(0U, 1U)->shown().value.get()));
+   EXPECT_EQ(BigInt::Fixed("6"), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(0U, 1U)->shown().value)->value);
+   EXPECT_EQ(shet.getCellAt(0U, 1U)->previousValue.get(), shet.getCellAt(0U, 1U)->shown().value.get());
+ }
+
+TEST(EngineTests, testSpreadSheet_ParseAll)
+ {
+   Forwards::Engine::CallingContext context;
+   Forwards::Engine::SpreadSheet shet;
+   context.theSheet = &shet;
+   Forwards::Engine::NameMap names;
+   context.names = &names;
+   Forwards::Engine::GetterMap map;
+   context.map = &map;
+   shet.threads = 4U;
+
+   for (size_t row = 0U; row < 100U; ++row)
+    {
+      setCell(shet, 0U, row, std::to_string(row) + "*2");
+    }
+   setCell(shet, 1U, 0U, "A1+");
+   setCell(shet, 1U, 1U, "A1+A100");
+
+   std::map<Forwards::Engine::CellLocation, std::string> errors = shet.parseAll(context);
+   ASSERT_EQ(1U, errors.size());
+   EXPECT_TRUE(errors.end() != errors.find(Forwards::Engine::CellLocation(1U, 0U)));
+   EXPECT_FALSE(errors.begin()->second.empty());
+
+   for (size_t row = 0U; row < 100U; ++row)
+    {
+      EXPECT_TRUE(nullptr != shet.getCellAt(0U, row)->value.get());
+      EXPECT_EQ("", shet.getCellAt(0U, row)->currentInput);
+    }
+   EXPECT_TRUE(nullptr == shet.getCellAt(1U, 0U)->value.get());
+   EXPECT_EQ("A1+", shet.getCellAt(1U, 0U)->currentInput);
+
+   shet.recalc(context);
+   ASSERT_TRUE(typeid(Forwards::Types::FloatValue) == typeid(*shet.getCellAt(0U, 99U)->previousValue.get()));
+   EXPECT_EQ(BigInt::Fixed("198"), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(0U, 99U)->previousValue)->value);
+ }
+
+TEST(EngineTests, testSpreadSheet_SharedFormulas)
+ {
+   Forwards::Engine::CallingContext context;
+   Forwards::Engine::SpreadSheet shet;
+   context.theSheet = &shet;
+   Forwards::Engine::NameMap names;
+   context.names = &names;
+   Forwards::Engine::GetterMap map;
+   context.map = &map;
+
+   setCell(shet, 0U, 0U, "1");
+   for (size_t row = 1U; row < 10U; ++row) // Filled down: A(n) = A(n-1)*2+$A$1
+    {
+      setCell(shet, 0U, row, "A" + std::to_string(row) + "*2+$A$1");
+    }
+   setCell(shet, 1U, 1U, "A1*2+$A$1"); // The same text, but not the same formula.
+   setCell(shet, 1U, 2U, "B2 * 2+$A$1"); // The same formula, but with different error locations.
+   shet.recalc(context);
+
+   for (size_t row = 2U; row < 10U; ++row)
+    {
+      EXPECT_EQ(shet.getCellAt(0U, 1U)->value.get(), shet.getCellAt(0U, row)->value.get());
+    }
+   EXPECT_NE(shet.getCellAt(0U, 1U)->value.get(), shet.getCellAt(1U, 1U)->value.get());
+   EXPECT_NE(shet.getCellAt(0U, 1U)->value.get(), shet.getCellAt(1U, 2U)->value.get());
+   EXPECT_EQ("A9*2+$A$1", shet.getCellAt(0U, 9U)->value->toString(0U, 9U));
+   ASSERT_TRUE(typeid(Forwards::Types::FloatValue) == typeid(*shet.getCellAt(0U, 9U)->previousValue.get()));
+   EXPECT_EQ(BigInt::Fixed("1023"), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(0U, 9U)->previousValue)->value);
+
+      // Editing one cell doesn't change the others.
+   const Forwards::Engine::Expression* shared = shet.getCellAt(0U, 5U)->value.get();
+   setCell(shet, 0U, 5U, "A5+1");
+   shet.update(context);
+   EXPECT_NE(shared, shet.getCellAt(0U, 5U)->value.get());
+   EXPECT_EQ(shared, shet.getCellAt(0U, 6U)->value.get());
+   EXPECT_EQ(BigInt::Fixed("527"), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(0U, 9U)->previousValue)->value);
+ }
@@ -34,6 +34,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "Backwards/Engine/CallingContext.h"
 
+#include "Fixed.hpp"
+
 #include <vector>
 
 namespace Forwards
@@ -68,13 +70,18 @@ namespace Engine
       SpreadSheet* theSheet;
       GetterMap* map;
       NameMap* names;
+      BigInt::Fixed_Context numeric; // The scale and rounding mode the sheet is computed with.
 
       CellFrame* topCell();
       void pushCell(CellFrame* cell);
       void popCell();
+      size_t depth() const; // How many cells are being evaluated?
 
       virtual std::shared_ptr<Backwards::Engine::CallingContext> duplicate() override; // This function exists for the debugger.
 
+         // Setting a library's global from a cell is a side effect, like LET.
+      virtual void beforeSharedWrite() override;
+
    private:
       std::vector<CellFrame*> cells;
 
@@ -35,31 +35,91 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Forwards/Types/ValueType.h"
 #include "Forwards/Engine/Expression.h"
 
+#include <atomic>
+#include <memory>
+#include <string>
+
 namespace Forwards
  {
 
 namespace Engine
  {
 
-   enum CellType
+   enum CellType : unsigned char
     {
       ERROR,
       VALUE,
       LABEL
     };
 
+      /*
+         A cell's input text. It is only kept until the input is parsed, or for a label, so most cells don't have any:
+         it is kept out of line, and a cell without any holds only a null pointer.
+      */
+   class CellInput final
+    {
+   public:
+      CellInput() = default;
+      CellInput(const CellInput&) = delete;
+      CellInput& operator=(const CellInput&) = delete;
+
+      CellInput& operator=(std::string);
+      CellInput& operator+=(const std::string&);
+
+      operator const std::string& () const;
+      bool empty() const { return nullptr == text.get(); }
+      size_t size() const { return (nullptr == text.get()) ? 0U : text->size(); }
+
+   private:
+      std::unique_ptr<std::string> text; // Never an empty string
+    };
+
+   bool operator==(const CellInput&, const std::string&);
+   bool operator==(const std::string&, const CellInput&);
+   bool operator==(const CellInput&, const char*);
+   bool operator==(const char*, const CellInput&);
+   bool operator!=(const CellInput&, const std::string&);
+   bool operator!=(const std::string&, const CellInput&);
+   bool operator!=(const CellInput&, const char*);
+   bool operator!=(const char*, const CellInput&);
+
+      // What the display shows for a cell: the previousValue of the last finished recalc or update. See SpreadSheet::snapshotLock.
+   class CellShown final
+    {
+   public:
+      std::shared_ptr<Types::ValueType> value;
+      bool recursed;
+
+      CellShown() : recursed(false) { }
+    };
+
+   /*
+      Cells are allocated from a pool of slabs, rather than one at a time from the heap:
+      loading a big sheet doesn't thrash the allocator, and neighboring cells tend to be neighbors in memory.
+      A cell only holds what a recalc uses. What only the display uses is kept in the slab, apart from the cells,
+      and the input is kept out of line. The members are ordered largest to smallest, so that the type and flags pack into one word.
+   */
    class Cell final
     {
    public:
-      CellType type;
-      std::string currentInput;
       std::shared_ptr<Expression> value;
       std::shared_ptr<Types::ValueType> previousValue;
-      size_t previousGeneration;
+      CellInput currentInput;
+      std::atomic<size_t> previousGeneration; // Atomic, as other threads check this in a parallel recalc. Set it after previousValue.
+      CellType type;
       bool inEvaluation;
       bool recursed;
+      bool waiting; // Its evaluation was unwound to wait for another cell, and will carry on from the worklist.
+
+      Cell() : previousGeneration(0U), type(ERROR), inEvaluation(false), recursed(false), waiting(false) { }
+      ~Cell();
+
+      CellShown& shown() const;
+
+      static void* operator new(size_t);
+      static void operator delete(void*);
 
-      Cell() : type(ERROR), previousGeneration(0U), inEvaluation(false), recursed(false) { }
+      static size_t slabs(); // How many slabs the pool holds.
     };
 
  } // namespace Engine
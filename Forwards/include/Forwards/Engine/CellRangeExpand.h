@@ -52,6 +52,7 @@ namespace Engine
       virtual std::shared_ptr<Backwards::Types::ValueType> expand (Backwards::Engine::CallingContext&) const override;
       virtual std::shared_ptr<Backwards::Types::ValueType> getIndex (size_t index) const override;
       virtual size_t getSize() const override;
+      virtual std::unique_ptr<Backwards::Types::CellRangeCursor> getCursor() const override; // Reuses the last element when it can.
 
       virtual bool equal (const Backwards::Types::CellRangeValue& lhs) const override;
       virtual bool notEqual (const Backwards::Types::CellRangeValue& lhs) const override;
@@ -0,0 +1,94 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef FORWARDS_ENGINE_COLUMN_H
+#define FORWARDS_ENGINE_COLUMN_H
+
+#include <map>
+#include <memory>
+
+namespace Forwards
+ {
+
+namespace Engine
+ {
+
+   class Cell;
+
+   /*
+      A column of the sheet.
+      Cells are kept in blocks of BLOCK_SIZE rows, and a block only exists while it holds a cell.
+      A column with one cell at row 50,000,000 is one block, not fifty million null pointers.
+      The size of a column is what it would be for a vector of cells: one past the last row that was used.
+   */
+   class Column final
+    {
+   public:
+      static const size_t BLOCK_SIZE = 64U;
+      static const size_t NONE = static_cast<size_t>(0U) - 1U;
+
+      Column();
+      Column(Column&&);
+      Column& operator=(Column&&);
+      ~Column();
+
+      size_t size() const;
+      size_t count() const; // How many cells are there?
+      void resize(size_t size); // Cells past the new size are deleted.
+      void clear();
+
+      Cell* get(size_t row) const;
+      void set(size_t row, std::unique_ptr<Cell>&& cell); // The column grows to include row, even if cell is null.
+      std::unique_ptr<Cell> take(size_t row); // The column doesn't shrink.
+      void reset(size_t row);
+
+      void insert(size_t row); // Move every cell at or after row down one.
+      void erase(size_t row); // Delete the cell at row, and move every cell after it up one.
+
+         // To visit only the rows with cells.
+      size_t next(size_t row) const; // The first row at or after row with a cell, else size().
+      size_t previous(size_t row) const; // The last row before row with a cell, else NONE.
+
+   private:
+      class Block;
+
+      std::map<size_t, std::unique_ptr<Block> > blocks;
+      size_t length;
+      size_t population;
+
+      void put(size_t row, std::unique_ptr<Cell>&& cell);
+    };
+
+ } // namespace Engine
+
+ } // namespace Forwards
+
+#endif /* FORWARDS_ENGINE_COLUMN_H */
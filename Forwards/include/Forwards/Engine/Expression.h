@@ -95,9 +95,23 @@ namespace Engine
       std::string toString(size_t, size_t, int) const override; \
     };
 
-   FFBinaryOperation(Plus)
-   FFBinaryOperation(Minus)
    FFBinaryOperation(Multiply)
+
+      // A product added to a number is done as one multiply-add. Which side is a product is found once, when the tree is built.
+   class Plus final : public Expression
+    {
+   public:
+      std::shared_ptr<Expression> lhs, rhs;
+      Plus(const Input::Token&, const std::shared_ptr<Expression>&, const std::shared_ptr<Expression>&);
+      std::shared_ptr<Types::ValueType> evaluate (CallingContext&) const override;
+      std::string toString(size_t, size_t, int) const override;
+
+   private:
+      const Multiply* lhsProduct; // Else nullptr
+      const Multiply* rhsProduct;
+    };
+
+   FFBinaryOperation(Minus)
    FFBinaryOperation(Divide)
    FFBinaryOperation(Equals)
    FFBinaryOperation(NotEqual)
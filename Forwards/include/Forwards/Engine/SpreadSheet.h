@@ -32,8 +32,16 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef FORWARDS_ENGINE_SPREADSHEET_H
 #define FORWARDS_ENGINE_SPREADSHEET_H
 
+#include "Forwards/Engine/Column.h"
+
 #include <vector>
 #include <memory>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
 
 namespace Forwards
  {
@@ -43,20 +51,29 @@ namespace Types
    class ValueType;
  }
 
+namespace Parser
+ {
+   class FormulaCache;
+ }
+
 namespace Engine
  {
 
    class CallingContext;
    class Cell;
 
+   typedef std::pair<size_t, size_t> CellLocation; // Column, then row
+   typedef std::pair<CellLocation, CellLocation> CellArea; // Top-left, then bottom-right
+
    class SpreadSheet final
     {
    public:
       SpreadSheet();
+      ~SpreadSheet();
       SpreadSheet(const SpreadSheet&) = delete;
       SpreadSheet& operator=(const SpreadSheet&) = delete;
 
-      std::vector<std::vector<std::unique_ptr<Cell> > > sheet;
+      std::vector<Column> sheet;
 
       size_t max_row;
 
@@ -64,6 +81,21 @@ namespace Engine
       bool top_down;
       bool left_right;
 
+      size_t threads; // How many threads a recalc may use.
+
+         // Set from another thread to stop a recalc or update at the next cell, even partway through evaluating a cell.
+         // It stays set until it is cleared. The sheet remembers what is left to do, and the next update picks up from there.
+      std::atomic<bool> cancelled;
+
+         // How far along the recalc or update in progress is, for another thread to report.
+      std::atomic<size_t> progress; // Cells evaluated.
+      std::atomic<size_t> progressTotal; // Cells to evaluate. An update may find more as it goes.
+
+         // Another thread may read a cell's shown values, value, and currentInput while it holds this.
+         // The shown values are only set, from the working ones, once a recalc or update finishes,
+         // so a reader sees the whole of the last finished generation and none of the next.
+      std::mutex snapshotLock;
+
       Cell* getCellAt(size_t col, size_t row);
       void initCellAt(size_t col, size_t row);
 
@@ -85,8 +117,78 @@ namespace Engine
       std::shared_ptr<Types::ValueType> computeCell(CallingContext&, size_t col, size_t row, bool rethrow);
       void recalc(CallingContext&);
 
+         // The value of a cell, as a reference to it sees it: computed if it hasn't been yet, and Nil if there is no cell.
+      std::shared_ptr<Types::ValueType> getValueAt(CallingContext&, Cell*, size_t col, size_t row);
+
+         // Parse every formula that hasn't been, on as many threads as a recalc may use, so that a recalc need only evaluate.
+         // Nothing else may use the sheet meanwhile. Returns the first parse error of each formula that failed.
+      std::map<CellLocation, std::string> parseAll(CallingContext&);
+
+         // Incremental recalculation.
+         // Every evaluation records which cells and ranges it referenced, so that an edit
+         // need only recompute the cells that (transitively) depend on what was edited.
+      void recordReference(CallingContext&, size_t col, size_t row);
+      void recordRange(CallingContext&, size_t col1, size_t row1, size_t col2, size_t row2);
+      void markOrderDependent(CallingContext&); // The current cell has a side effect (LET).
+
+      void markDirty(size_t col, size_t row);
+      void markAllDirty(); // The next update will be a full recalc.
+      void update(CallingContext&); // Recompute what is dirty, or recalc if that isn't safe.
+
+         // In a parallel recalc, is this cell another thread's? If so, either get its value or defer the current cell.
+      bool readOtherThread(CallingContext&, Cell*, size_t col, std::shared_ptr<Types::ValueType>& OUT);
+
    private:
+      class Worker;
+
+      class Deferred;
+
+      class Cancelled;
+
+      class Rounds;
+
+      class RangeIndex;
+
       void swap(size_t col1, size_t col2, size_t row); // col2 > col1
+
+      void startRecalc(CallingContext&);
+      void finishRecalc();
+      void resumeRecalc(CallingContext&); // Evaluate what a cancelled recalc didn't, and what was edited since.
+      void evaluateInOrder(CallingContext&, size_t firstCol, size_t lastCol);
+      void evaluateOne(CallingContext&, size_t col, size_t row);
+      size_t nextRow(size_t firstCol, size_t lastCol, size_t row) const; // The first row at or after row with a cell, else max_row.
+      size_t previousRow(size_t firstCol, size_t lastCol, size_t row) const; // The last row before row with a cell, else Column::NONE.
+      bool recalcInParallel(CallingContext&);
+      void work(CallingContext&, Worker&, Rounds&); // Evaluate the worker's columns each round, until told to stop.
+
+      static thread_local Worker* currentWorker;
+      static thread_local bool suspendable; // Can a deeply-nested cell be put on the worklist?
+      std::atomic<bool> abandonParallel;
+
+      std::map<CellLocation, std::set<CellLocation> > dependents; // Who references this location?
+      std::map<CellLocation, std::vector<CellLocation> > precedents; // What does this cell reference?
+      std::map<CellLocation, std::vector<CellArea> > ranges; // What ranges does this cell reference?
+      std::unique_ptr<RangeIndex> rangeIndex; // Which cells reference a range over this location?
+      std::set<CellLocation> orderDependent; // Cells whose value depends on the order of evaluation.
+      std::set<CellLocation> dirty; // Cells that have been edited since the last update.
+      std::set<CellLocation> pending; // Cells that need recomputing in this update.
+      bool graphValid;
+      bool resumable; // A recalc was cancelled: what it finished is still good.
+      bool incremental;
+      bool abandon;
+
+      std::set<CellLocation> unpublished; // Cells evaluated since the values were last shown.
+      bool publishAll;
+      void publish(); // Show the values of what has been evaluated.
+
+      std::unique_ptr<Parser::FormulaCache> formulas; // Cells with the same formula share its tree.
+
+      void forgetReferences(const CellLocation&);
+      void schedule(const CellLocation&);
+      void scheduleDependents(const CellLocation&);
+      void dependentsOf(const CellLocation&, std::vector<CellLocation>&) const; // The cells that reference the location, or a range over it.
+      void startEvaluation(CallingContext&, const CellLocation&);
+      void finishEvaluation(CallingContext&, Cell*, const CellLocation&, const std::shared_ptr<Types::ValueType>&, bool);
     };
 
  } // namespace Engine
@@ -47,6 +47,13 @@ namespace Engine
 
    STDLIB_UNARY_DECL_WITH_CONTEXT(CellEval);
 
+      // Native SUM, COUNT, AVERAGE, MAX, and MIN: they take the array of arguments, and walk ranges in the sheet.
+   STDLIB_UNARY_DECL_WITH_CONTEXT(CellSum);
+   STDLIB_UNARY_DECL_WITH_CONTEXT(CellCount);
+   STDLIB_UNARY_DECL_WITH_CONTEXT(CellAverage);
+   STDLIB_UNARY_DECL_WITH_CONTEXT(CellMax);
+   STDLIB_UNARY_DECL_WITH_CONTEXT(CellMin);
+
 
    typedef std::shared_ptr<Backwards::Types::ValueType> (*BinaryFunctionPointerWithContext) (Backwards::Engine::CallingContext& context,
       const std::shared_ptr<Backwards::Types::ValueType>&, const std::shared_ptr<Backwards::Types::ValueType>&);
@@ -0,0 +1,76 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef FORWARDS_PARSER_FORMULACACHE_H
+#define FORWARDS_PARSER_FORMULACACHE_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "Forwards/Parser/Parser.h"
+
+namespace Forwards
+ {
+
+namespace Parser
+ {
+
+   /*
+      The parser makes cell references relative, so a formula filled down a column parses to the same tree in every row.
+      This keeps one tree for each such formula, keyed by its normal form, for every cell that has it to share.
+      Trees are never changed once built: editing a cell gives it a new tree, and leaves the shared one alone.
+      Only weak references are kept, so a tree is freed along with the last cell that used it.
+   */
+   class FormulaCache final
+    {
+   public:
+      FormulaCache();
+      FormulaCache(const FormulaCache&) = delete;
+      FormulaCache& operator=(const FormulaCache&) = delete;
+
+         // As Parser::ParseFullExpression, for the formula in input at (col, row). Safe to call from multiple threads.
+      std::shared_ptr<Engine::Expression> parse(const std::string& input, const Engine::GetterMap&, Backwards::Engine::Logger&, size_t col, size_t row);
+
+      size_t size(); // How many formulas are live?
+
+   private:
+      std::mutex lock;
+      std::unordered_map<std::string, std::weak_ptr<Engine::Expression> > formulas;
+      size_t nextPurge; // Forget the formulas no cell uses once there are this many.
+    };
+
+ } // namespace Parser
+
+ } // namespace Forwards
+
+#endif /* FORWARDS_PARSER_FORMULACACHE_H */
@@ -66,6 +66,10 @@ namespace Parser
 
       static std::shared_ptr<Engine::Expression> ParseFullExpression (Input::Lexer& src, const Engine::GetterMap&, Backwards::Engine::Logger&, size_t, size_t);
 
+         // The tokens of an expression, with the cell references made relative, as the parser would.
+         // Expressions with the same normal form parse to the same tree, wherever they are. Empty if it won't lex.
+      static std::string Normalize (Input::Lexer& src, size_t, size_t);
+
    private:
 
       static void expect (Input::Lexer& src, Input::Lexeme expected, const std::string& name);
@@ -77,6 +81,7 @@ namespace Parser
       static std::shared_ptr<Engine::Expression> primary (Input::Lexer& src, const Engine::GetterMap&, Backwards::Engine::Logger&, size_t, size_t);
 
       static std::shared_ptr<Engine::Expression> cellref (const Input::Token&, size_t, size_t);
+      static void reference (const Input::Token&, size_t, size_t, bool& colAbsolute, int64_t& r_col, bool& rowAbsolute, int64_t& r_row);
     };
 
  } // namespace Parser
@@ -30,6 +30,7 @@ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #include "Forwards/Engine/CallingContext.h"
+#include "Forwards/Engine/SpreadSheet.h"
 
 namespace Forwards
  {
@@ -60,6 +61,19 @@ namespace Engine
       cells.pop_back();
     }
 
+   size_t CallingContext::depth() const
+    {
+      return cells.size();
+    }
+
+   void CallingContext::beforeSharedWrite()
+    {
+      if (nullptr != theSheet)
+       {
+         theSheet->markOrderDependent(*this);
+       }
+    }
+
    std::shared_ptr<Backwards::Engine::CallingContext> CallingContext::duplicate()
     {
       std::shared_ptr<CallingContext> result = std::make_shared<CallingContext>();
@@ -72,6 +86,7 @@ namespace Engine
       Backwards::Engine::CallingContext::duplicate(result);
       result->generation = generation;
       result->theSheet = theSheet;
+      result->numeric = numeric;
       result->pushCell(topCell());
     }
 
@@ -0,0 +1,316 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Forwards/Engine/Cell.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+namespace Forwards
+ {
+
+namespace Engine
+ {
+
+   CellInput& CellInput::operator=(std::string input)
+    {
+      if (true == input.empty())
+       {
+         text.reset();
+       }
+      else if (nullptr != text.get())
+       {
+         *text = std::move(input);
+       }
+      else
+       {
+         text = std::make_unique<std::string>(std::move(input));
+       }
+      return *this;
+    }
+
+   CellInput& CellInput::operator+=(const std::string& more)
+    {
+      if (true == more.empty())
+       {
+         return *this;
+       }
+      if (nullptr == text.get())
+       {
+         text = std::make_unique<std::string>(more);
+       }
+      else
+       {
+         *text += more;
+       }
+      return *this;
+    }
+
+   CellInput::operator const std::string& () const
+    {
+      static const std::string none;
+      return (nullptr == text.get()) ? none : *text;
+    }
+
+   bool operator==(const CellInput& lhs, const std::string& rhs) { return static_cast<const std::string&>(lhs) == rhs; }
+   bool operator==(const std::string& lhs, const CellInput& rhs) { return lhs == static_cast<const std::string&>(rhs); }
+   bool operator==(const CellInput& lhs, const char* rhs) { return static_cast<const std::string&>(lhs) == rhs; }
+   bool operator==(const char* lhs, const CellInput& rhs) { return lhs == static_cast<const std::string&>(rhs); }
+   bool operator!=(const CellInput& lhs, const std::string& rhs) { return !(lhs == rhs); }
+   bool operator!=(const std::string& lhs, const CellInput& rhs) { return !(lhs == rhs); }
+   bool operator!=(const CellInput& lhs, const char* rhs) { return !(lhs == rhs); }
+   bool operator!=(const char* lhs, const CellInput& rhs) { return !(lhs == rhs); }
+
+   namespace
+    {
+
+      union Slot
+       {
+         Slot* next;
+         alignas(Cell) unsigned char storage[sizeof(Cell)];
+       };
+
+         // A slab is aligned to its size, so that a cell finds its slab, and what is shown for it, from its own address.
+      const size_t SLAB_BYTES = static_cast<size_t>(64U) << 10;
+      const size_t SLAB_HEADER = 4U * sizeof(void*);
+      const size_t SLAB_SIZE = (SLAB_BYTES - SLAB_HEADER) / (sizeof(Slot) + sizeof(CellShown)); // Cells per slab.
+
+      class Slab final
+       {
+      public:
+         Slab* previous; // The slabs with a free cell are kept on a list.
+         Slab* next;
+         Slot* free;
+         size_t used;
+         CellShown shown [SLAB_SIZE]; // Apart from the cells, so that a recalc doesn't sweep through them.
+         Slot slots [SLAB_SIZE];
+
+         static Slab* of(const void* pointer)
+          {
+            return reinterpret_cast<Slab*>(reinterpret_cast<std::uintptr_t>(pointer) & ~static_cast<std::uintptr_t>(SLAB_BYTES - 1U));
+          }
+       };
+
+      static_assert(sizeof(Slab) <= SLAB_BYTES, "A slab doesn't fit in its block.");
+
+#if defined(_WIN32)
+      void* allocateBlock()
+       {
+         void* result = _aligned_malloc(SLAB_BYTES, SLAB_BYTES);
+         if (nullptr == result) throw std::bad_alloc();
+         return result;
+       }
+
+      void freeBlock(void* block)
+       {
+         _aligned_free(block);
+       }
+#else
+      void* allocateBlock()
+       {
+         void* result = nullptr;
+         if (0 != posix_memalign(&result, SLAB_BYTES, SLAB_BYTES)) throw std::bad_alloc();
+         return result;
+       }
+
+      void freeBlock(void* block)
+       {
+         std::free(block);
+       }
+#endif
+
+         // Freed cells go on their slab's free list, and are reused before a new slab is allocated.
+         // A slab is given back once all of its cells are free, except for the last one to empty:
+         // freeing one cell and then making another doesn't give back and allocate a slab each time.
+      class Pool final
+       {
+      public:
+         Pool() : partial(nullptr), spare(nullptr), count(0U) { }
+
+         void* allocate()
+          {
+            std::lock_guard<std::mutex> guard (lock);
+            if (nullptr == partial)
+             {
+               link(make());
+             }
+            Slab* slab = partial;
+            Slot* result = slab->free;
+            slab->free = result->next;
+            ++slab->used;
+            if (slab == spare)
+             {
+               spare = nullptr;
+             }
+            if (nullptr == slab->free)
+             {
+               unlink(slab);
+             }
+            return result;
+          }
+
+         void release(void* pointer)
+          {
+            std::lock_guard<std::mutex> guard (lock);
+            Slab* slab = Slab::of(pointer);
+            Slot* slot = static_cast<Slot*>(pointer);
+            if (nullptr != slab->free)
+             {
+               unlink(slab);
+             }
+            slot->next = slab->free;
+            slab->free = slot;
+            --slab->used;
+            link(slab); // At the front: the cell just freed is the next one reused.
+
+            if (0U == slab->used)
+             {
+               if ((nullptr != spare) && (slab != spare))
+                {
+                  unlink(spare);
+                  destroy(spare);
+                }
+               spare = slab;
+             }
+          }
+
+         size_t slabs()
+          {
+            std::lock_guard<std::mutex> guard (lock);
+            return count;
+          }
+
+      private:
+         std::mutex lock;
+         Slab* partial;
+         Slab* spare; // An empty slab that was kept.
+         size_t count;
+
+         Slab* make()
+          {
+            Slab* slab = new (allocateBlock()) Slab();
+            slab->previous = nullptr;
+            slab->next = nullptr;
+            slab->free = nullptr;
+            slab->used = 0U;
+            for (size_t i = SLAB_SIZE; i > 0U; --i)
+             {
+               slab->slots[i - 1U].next = slab->free;
+               slab->free = &slab->slots[i - 1U];
+             }
+            ++count;
+            return slab;
+          }
+
+         void destroy(Slab* slab)
+          {
+            slab->~Slab();
+            freeBlock(slab);
+            --count;
+          }
+
+         void link(Slab* slab)
+          {
+            slab->previous = nullptr;
+            slab->next = partial;
+            if (nullptr != partial)
+             {
+               partial->previous = slab;
+             }
+            partial = slab;
+          }
+
+         void unlink(Slab* slab)
+          {
+            if (nullptr != slab->previous)
+             {
+               slab->previous->next = slab->next;
+             }
+            else
+             {
+               partial = slab->next;
+             }
+            if (nullptr != slab->next)
+             {
+               slab->next->previous = slab->previous;
+             }
+            slab->previous = nullptr;
+            slab->next = nullptr;
+          }
+       };
+
+         // Never destroyed, as a sheet with static storage duration may outlive any static Pool.
+      Pool& thePool()
+       {
+         static Pool* pool = new Pool();
+         return *pool;
+       }
+
+    }
+
+   Cell::~Cell()
+    {
+      shown() = CellShown(); // The next cell here starts with nothing shown.
+    }
+
+   CellShown& Cell::shown() const
+    {
+      Slab* slab = Slab::of(this);
+      return slab->shown[reinterpret_cast<const Slot*>(this) - slab->slots];
+    }
+
+   void* Cell::operator new(size_t)
+    {
+      return thePool().allocate();
+    }
+
+   void Cell::operator delete(void* pointer)
+    {
+      if (nullptr != pointer)
+       {
+         thePool().release(pointer);
+       }
+    }
+
+   size_t Cell::slabs()
+    {
+      return thePool().slabs();
+    }
+
+ } // namespace Engine
+
+ } // namespace Forwards
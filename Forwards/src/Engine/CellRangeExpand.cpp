@@ -54,134 +54,168 @@ namespace Engine
     {
     }
 
-   std::shared_ptr<Backwards::Types::ValueType> CellRangeExpand::expand (Backwards::Engine::CallingContext&) const
+   static std::shared_ptr<Backwards::Types::ValueType> makeCell (size_t col, size_t row)
     {
-      std::shared_ptr<Backwards::Types::ArrayValue> result = std::make_shared<Backwards::Types::ArrayValue>();
+      return std::make_shared<Backwards::Types::CellRefValue>(
+         std::make_shared<CellRefEval>(
+            std::make_shared<Constant>(Input::Token(),
+               std::make_shared<Types::CellRefValue>(true, col, true, row))));
+    }
+
+   static std::shared_ptr<Backwards::Types::ValueType> makeColumn (size_t col, size_t row1, size_t row2)
+    {
+      return std::make_shared<Backwards::Types::CellRangeValue>(
+         std::make_shared<CellRangeExpand>(
+            std::make_shared<Types::CellRangeValue>(col, row1, col, row2)));
+    }
 
-         // This should never be true, but if it is...
-      if ((value->col1 == value->col2) && (value->row1 == value->row2))
+      // 2d cell ranges are a column-major array of columns; 1d cell ranges are an array of cells.
+   static bool hasColumns (const Types::CellRangeValue& range)
+    {
+      return (range.col1 != range.col2) && (range.row1 != range.row2);
+    }
+
+   static size_t sizeOf (const Types::CellRangeValue& range)
+    {
+      return (range.col1 == range.col2) ? range.row2 - range.row1 + 1U : range.col2 - range.col1 + 1U;
+    }
+
+      // The cell that a 1d range's element is.
+   static void locate (const Types::CellRangeValue& range, size_t index, size_t& col, size_t& row)
+    {
+      if (range.row1 == range.row2)
        {
-         result->value.emplace_back(
-            std::make_shared<Backwards::Types::CellRefValue>(
-               std::make_shared<CellRefEval>(
-                  std::make_shared<Constant>(Input::Token(),
-                     std::make_shared<Types::CellRefValue>(true, value->col1, true, value->row1)))));
+         col = range.col1 + index;
+         row = range.row1;
        }
-      else if (value->col1 == value->col2)
+      else
        {
-         for (size_t row = value->row1; row <= value->row2; ++row)
-          {
-            result->value.emplace_back(
-               std::make_shared<Backwards::Types::CellRefValue>(
-                  std::make_shared<CellRefEval>(
-                     std::make_shared<Constant>(Input::Token(),
-                        std::make_shared<Types::CellRefValue>(true, value->col1, true, row)))));
-          }
+         col = range.col1;
+         row = range.row1 + index;
        }
-      else if (value->row1 == value->row2)
+    }
+
+      // If the cursor is all that holds its last element, all the way down, then the last element's cell reference or range can be changed.
+   static Types::ValueType* reusable (const std::shared_ptr<Backwards::Types::ValueType>& last)
+    {
+      if ((nullptr == last.get()) || (1 != last.use_count()))
        {
-         for (size_t col = value->col1; col <= value->col2; ++col)
-          {
-            result->value.emplace_back(
-               std::make_shared<Backwards::Types::CellRefValue>(
-                  std::make_shared<CellRefEval>(
-                     std::make_shared<Constant>(Input::Token(),
-                        std::make_shared<Types::CellRefValue>(true, col, true, value->row1)))));
-          }
+         return nullptr;
        }
-      else
+      if (typeid(Backwards::Types::CellRefValue) == typeid(*last))
        {
-         for (size_t col = value->col1; col <= value->col2; ++col)
+         const std::shared_ptr<Backwards::Types::CellRefHolder>& eval = static_cast<const Backwards::Types::CellRefValue&>(*last).value;
+         if (1 != eval.use_count())
           {
-            result->value.emplace_back(
-               std::make_shared<Backwards::Types::CellRangeValue>(
-                  std::make_shared<CellRangeExpand>(
-                     std::make_shared<Types::CellRangeValue>(col, value->row1, col, value->row2))));
+            return nullptr;
           }
+         const std::shared_ptr<Expression>& expr = static_cast<const CellRefEval&>(*eval).value;
+         if (1 != expr.use_count())
+          {
+            return nullptr;
+          }
+         const std::shared_ptr<Types::ValueType>& ref = static_cast<const Constant&>(*expr).value;
+         return (1 == ref.use_count()) ? ref.get() : nullptr;
        }
-
-      return result;
+      const std::shared_ptr<Backwards::Types::CellRangeHolder>& expand = static_cast<const Backwards::Types::CellRangeValue&>(*last).value;
+      if (1 != expand.use_count())
+       {
+         return nullptr;
+       }
+      const std::shared_ptr<Types::CellRangeValue>& column = static_cast<const CellRangeExpand&>(*expand).value;
+      return (1 == column.use_count()) ? column.get() : nullptr;
     }
 
-   std::shared_ptr<Backwards::Types::ValueType> CellRangeExpand::getIndex (size_t index) const
+   class RangeCursor final : public Backwards::Types::CellRangeCursor
     {
-      std::shared_ptr<Backwards::Types::ValueType> result;
+   public:
+      explicit RangeCursor(const std::shared_ptr<Types::CellRangeValue>& range) : range(range), index(0U), size(sizeOf(*range)), columns(hasColumns(*range)) { }
 
-         // This should never be true, but if it is...
-      if ((value->col1 == value->col2) && (value->row1 == value->row2))
-       {
-         if (0U == index)
-          {
-            result =
-               std::make_shared<Backwards::Types::CellRefValue>(
-                  std::make_shared<CellRefEval>(
-                     std::make_shared<Constant>(Input::Token(),
-                        std::make_shared<Types::CellRefValue>(true, value->col1, true, value->row1))));
-          }
-       }
-      else if (value->col1 == value->col2)
+      bool hasNext() const override
        {
-         if (value->row1 + index <= value->row2)
-          {
-            result =
-               std::make_shared<Backwards::Types::CellRefValue>(
-                  std::make_shared<CellRefEval>(
-                     std::make_shared<Constant>(Input::Token(),
-                        std::make_shared<Types::CellRefValue>(true, value->col1, true, value->row1 + index))));
-          }
+         return index < size;
        }
-      else if (value->row1 == value->row2)
+
+      std::shared_ptr<Backwards::Types::ValueType> next() override
        {
-         if (value->col1 + index <= value->col2)
+         Types::ValueType* reuse = reusable(last);
+         if (true == columns)
           {
-            result =
-               std::make_shared<Backwards::Types::CellRefValue>(
-                  std::make_shared<CellRefEval>(
-                     std::make_shared<Constant>(Input::Token(),
-                        std::make_shared<Types::CellRefValue>(true, value->col1 + index, true, value->row1))));
+            const size_t col = range->col1 + index;
+            if (nullptr != reuse)
+             {
+               Types::CellRangeValue* column = static_cast<Types::CellRangeValue*>(reuse);
+               column->col1 = col;
+               column->col2 = col;
+             }
+            else
+             {
+               last = makeColumn(col, range->row1, range->row2);
+             }
           }
-       }
-      else
-       {
-         if (value->col1 + index <= value->col2)
+         else
           {
-            result =
-               std::make_shared<Backwards::Types::CellRangeValue>(
-                  std::make_shared<CellRangeExpand>(
-                     std::make_shared<Types::CellRangeValue>(value->col1 + index, value->row1, value->col1 + index, value->row2)));
+            size_t col, row;
+            locate(*range, index, col, row);
+            if (nullptr != reuse)
+             {
+               Types::CellRefValue* cell = static_cast<Types::CellRefValue*>(reuse);
+               cell->colRef = col;
+               cell->rowRef = row;
+             }
+            else
+             {
+               last = makeCell(col, row);
+             }
           }
+         ++index;
+         return last;
        }
 
-      if (nullptr == result.get()) // Yes, this SHOULD be a TypedOperationException. It also SHOULD have been caught earlier.
+   private:
+      std::shared_ptr<Types::CellRangeValue> range;
+      size_t index;
+      size_t size;
+      bool columns;
+      std::shared_ptr<Backwards::Types::ValueType> last;
+    };
+
+   std::shared_ptr<Backwards::Types::ValueType> CellRangeExpand::expand (Backwards::Engine::CallingContext&) const
+    {
+      std::shared_ptr<Backwards::Types::ArrayValue> result = std::make_shared<Backwards::Types::ArrayValue>();
+      const size_t size = sizeOf(*value);
+      result->value.reserve(size);
+      for (size_t index = 0U; index < size; ++index)
        {
-         throw Backwards::Engine::ProgrammingException("CellRangeExpand::getIndex passed bad index.");
+         result->value.emplace_back(getIndex(index));
        }
-
       return result;
     }
 
-   size_t CellRangeExpand::getSize() const
+   std::shared_ptr<Backwards::Types::ValueType> CellRangeExpand::getIndex (size_t index) const
     {
-      size_t result;
-
-      if ((value->col1 == value->col2) && (value->row1 == value->row2))
-       {
-         result = 1U;
-       }
-      else if (value->col1 == value->col2)
+      if (index >= sizeOf(*value)) // Yes, this SHOULD be a TypedOperationException. It also SHOULD have been caught earlier.
        {
-         result = value->row2 - value->row1 + 1U;
+         throw Backwards::Engine::ProgrammingException("CellRangeExpand::getIndex passed bad index.");
        }
-//      else if (value->row1 == value->row2)
-//       {
-//         result = value->col2 - value->col1 + 1U;
-//       }
-      else
+
+      if (true == hasColumns(*value))
        {
-         result = value->col2 - value->col1 + 1U;
+         return makeColumn(value->col1 + index, value->row1, value->row2);
        }
+      size_t col, row;
+      locate(*value, index, col, row);
+      return makeCell(col, row);
+    }
 
-      return result;
+   size_t CellRangeExpand::getSize() const
+    {
+      return sizeOf(*value);
+    }
+
+   std::unique_ptr<Backwards::Types::CellRangeCursor> CellRangeExpand::getCursor() const
+    {
+      return std::make_unique<RangeCursor>(value);
     }
 
    bool CellRangeExpand::equal (const Backwards::Types::CellRangeValue& lhs) const
@@ -0,0 +1,216 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Forwards/Engine/Column.h"
+#include "Forwards/Engine/Cell.h"
+
+#include <array>
+
+namespace Forwards
+ {
+
+namespace Engine
+ {
+
+   class Column::Block final
+    {
+   public:
+      Block() : count(0U) { }
+
+      std::array<std::unique_ptr<Cell>, BLOCK_SIZE> cells;
+      size_t count;
+    };
+
+   const size_t Column::BLOCK_SIZE;
+   const size_t Column::NONE;
+
+   Column::Column() : length(0U), population(0U)
+    {
+    }
+
+   Column::Column(Column&&) = default;
+   Column& Column::operator=(Column&&) = default;
+   Column::~Column() = default;
+
+   size_t Column::size() const
+    {
+      return length;
+    }
+
+   size_t Column::count() const
+    {
+      return population;
+    }
+
+   void Column::resize(size_t size)
+    {
+      if (size < length)
+       {
+         for (size_t row = next(size); row < length; row = next(row + 1U))
+          {
+            reset(row);
+          }
+       }
+      length = size;
+    }
+
+   void Column::clear()
+    {
+      blocks.clear();
+      length = 0U;
+      population = 0U;
+    }
+
+   Cell* Column::get(size_t row) const
+    {
+      std::map<size_t, std::unique_ptr<Block> >::const_iterator block = blocks.find(row / BLOCK_SIZE);
+      if (blocks.end() != block)
+       {
+         return block->second->cells[row % BLOCK_SIZE].get();
+       }
+      return nullptr;
+    }
+
+   void Column::set(size_t row, std::unique_ptr<Cell>&& cell)
+    {
+      if (row >= length)
+       {
+         length = row + 1U;
+       }
+      put(row, std::move(cell));
+    }
+
+   std::unique_ptr<Cell> Column::take(size_t row)
+    {
+      std::unique_ptr<Cell> result;
+      std::map<size_t, std::unique_ptr<Block> >::iterator block = blocks.find(row / BLOCK_SIZE);
+      if (blocks.end() != block)
+       {
+         result.swap(block->second->cells[row % BLOCK_SIZE]);
+         if (nullptr != result.get())
+          {
+            --population;
+            --block->second->count;
+            if (0U == block->second->count)
+             {
+               blocks.erase(block);
+             }
+          }
+       }
+      return result;
+    }
+
+   void Column::reset(size_t row)
+    {
+      (void) take(row);
+    }
+
+   void Column::put(size_t row, std::unique_ptr<Cell>&& cell)
+    {
+      reset(row);
+      if (nullptr == cell.get())
+       {
+         return;
+       }
+      std::unique_ptr<Block>& block = blocks[row / BLOCK_SIZE];
+      if (nullptr == block.get())
+       {
+         block = std::make_unique<Block>();
+       }
+      block->cells[row % BLOCK_SIZE] = std::move(cell);
+      ++block->count;
+      ++population;
+    }
+
+   void Column::insert(size_t row)
+    {
+         // Work from the bottom, so that no cell is moved onto another.
+      for (size_t from = previous(length); (NONE != from) && (from >= row); from = previous(from))
+       {
+         put(from + 1U, take(from));
+       }
+      ++length;
+    }
+
+   void Column::erase(size_t row)
+    {
+      reset(row);
+      for (size_t from = next(row + 1U); from < length; from = next(from + 1U))
+       {
+         put(from - 1U, take(from));
+       }
+      --length;
+    }
+
+   size_t Column::next(size_t row) const
+    {
+      if (row >= length)
+       {
+         return length;
+       }
+      for (std::map<size_t, std::unique_ptr<Block> >::const_iterator block = blocks.lower_bound(row / BLOCK_SIZE); blocks.end() != block; ++block)
+       {
+         for (size_t i = (block->first == row / BLOCK_SIZE) ? row % BLOCK_SIZE : 0U; i < BLOCK_SIZE; ++i)
+          {
+            if (nullptr != block->second->cells[i].get())
+             {
+               return block->first * BLOCK_SIZE + i;
+             }
+          }
+       }
+      return length;
+    }
+
+   size_t Column::previous(size_t row) const
+    {
+      if (0U == row)
+       {
+         return NONE;
+       }
+      const size_t last = row - 1U;
+      std::map<size_t, std::unique_ptr<Block> >::const_iterator block = blocks.upper_bound(last / BLOCK_SIZE);
+      while (blocks.begin() != block)
+       {
+         --block;
+         for (size_t i = (block->first == last / BLOCK_SIZE) ? last % BLOCK_SIZE + 1U : BLOCK_SIZE; i > 0U; --i)
+          {
+            if (nullptr != block->second->cells[i - 1U].get())
+             {
+               return block->first * BLOCK_SIZE + i - 1U;
+             }
+          }
+       }
+      return NONE;
+    }
+
+ } // namespace Engine
+
+ } // namespace Forwards
@@ -150,33 +150,12 @@ namespace Engine
          row = Types::CellRefValue::getRow(context.topCell()->row, value->rowRef);
        }
 
-      Cell* cell = context.theSheet->getCellAt(col, row);
-         // If no cell, Nil.
-      if (nullptr == cell)
+      if ((col >= 0) && (row >= 0))
        {
-         return std::make_shared<Types::NilValue>();
-       }
-
-         // If we are currently evaluating this cell, stop.
-      if (true == cell->inEvaluation)
-       {
-         std::shared_ptr<Types::ValueType> result = cell->previousValue;
-         if (nullptr == result.get())
-          {
-            result = std::make_shared<Types::NilValue>();
-          }
-         cell->recursed = true;
-         return result;
+         context.theSheet->recordReference(context, col, row);
        }
 
-         // Guess we need to do work.
-      std::shared_ptr<Types::ValueType> result;
-      result = context.theSheet->computeCell(context, col, row, true);
-      if (nullptr == result.get())
-       {
-         result = std::make_shared<Types::NilValue>();
-       }
-      return result;
+      return context.theSheet->getValueAt(context, context.theSheet->getCellAt(col, row), col, row);
     }
 
 
@@ -186,12 +165,15 @@ namespace Engine
     { \
     }
 
-   OperationConstructor(Plus)
+   Plus::Plus(const Input::Token& token, const std::shared_ptr<Expression>& lhs, const std::shared_ptr<Expression>& rhs) :
+      Expression(token), lhs(lhs), rhs(rhs), lhsProduct(dynamic_cast<const Multiply*>(lhs.get())), rhsProduct(dynamic_cast<const Multiply*>(rhs.get()))
+    {
+    }
 
-   std::shared_ptr<Types::ValueType> Plus::evaluate (CallingContext& context) const
+   static std::shared_ptr<Types::ValueType> multiplyValues (const Expression&, const std::shared_ptr<Types::ValueType>&, const std::shared_ptr<Types::ValueType>&);
+
+   static std::shared_ptr<Types::ValueType> addValues (const Expression& op, const std::shared_ptr<Types::ValueType>& LHS, const std::shared_ptr<Types::ValueType>& RHS)
     {
-      std::shared_ptr<Types::ValueType> LHS = lhs->evaluate(context);
-      std::shared_ptr<Types::ValueType> RHS = rhs->evaluate(context);
       std::shared_ptr<Types::ValueType> result;
       switch (LHS->getType())
        {
@@ -207,7 +189,7 @@ namespace Engine
          case Types::STRING:
          case Types::CELL_REF:
          case Types::CELL_RANGE:
-            constructMessage("Error adding " + LHS->getTypeName() + " to " + RHS->getTypeName());
+            op.constructMessage("Error adding " + LHS->getTypeName() + " to " + RHS->getTypeName());
           }
          break;
       case Types::NIL:
@@ -222,17 +204,57 @@ namespace Engine
          case Types::STRING:
          case Types::CELL_REF:
          case Types::CELL_RANGE:
-            constructMessage("Error adding " + LHS->getTypeName() + " to " + RHS->getTypeName());
+            op.constructMessage("Error adding " + LHS->getTypeName() + " to " + RHS->getTypeName());
           }
          break;
       case Types::STRING:
       case Types::CELL_REF:
       case Types::CELL_RANGE:
-         constructMessage("Error adding " + LHS->getTypeName() + " to " + RHS->getTypeName());
+         op.constructMessage("Error adding " + LHS->getTypeName() + " to " + RHS->getTypeName());
        }
       return result;
     }
 
+   std::shared_ptr<Types::ValueType> Plus::evaluate (CallingContext& context) const
+    {
+         // A product and a number added together are done as one multiply-add, without the product as a value in between.
+         // Everything is evaluated in the same order, so that the same error is reported first.
+      const Multiply* product = lhsProduct;
+      if (nullptr != product)
+       {
+         std::shared_ptr<Types::ValueType> A = product->lhs->evaluate(context);
+         std::shared_ptr<Types::ValueType> B = product->rhs->evaluate(context);
+         if ((Types::FLOAT != A->getType()) || (Types::FLOAT != B->getType()))
+          {
+            std::shared_ptr<Types::ValueType> LHS = multiplyValues(*product, A, B);
+            return addValues(*this, LHS, rhs->evaluate(context));
+          }
+         std::shared_ptr<Types::ValueType> RHS = rhs->evaluate(context);
+         if (Types::FLOAT != RHS->getType())
+          {
+            return addValues(*this, multiplyValues(*product, A, B), RHS);
+          }
+         return std::make_shared<Types::FloatValue>(BigInt::Fixed::multiplyAdd(static_cast<Types::FloatValue*>(A.get())->value,
+            static_cast<Types::FloatValue*>(B.get())->value, static_cast<Types::FloatValue*>(RHS.get())->value, BigInt::Fixed::getContext()));
+       }
+
+      std::shared_ptr<Types::ValueType> LHS = lhs->evaluate(context);
+      product = rhsProduct;
+      if (nullptr != product)
+       {
+         std::shared_ptr<Types::ValueType> A = product->lhs->evaluate(context);
+         std::shared_ptr<Types::ValueType> B = product->rhs->evaluate(context);
+         if ((Types::FLOAT == LHS->getType()) && (Types::FLOAT == A->getType()) && (Types::FLOAT == B->getType()))
+          {
+            return std::make_shared<Types::FloatValue>(BigInt::Fixed::multiplyAdd(static_cast<Types::FloatValue*>(A.get())->value,
+               static_cast<Types::FloatValue*>(B.get())->value, static_cast<Types::FloatValue*>(LHS.get())->value, BigInt::Fixed::getContext()));
+          }
+         return addValues(*this, LHS, multiplyValues(*product, A, B));
+       }
+
+      return addValues(*this, LHS, rhs->evaluate(context));
+    }
+
    std::string Plus::toString(size_t col, size_t row, int level) const
     {
       return wrapInParens(lhs->toString(col, row, 2) + "+" + rhs->toString(col, row, 2), level, 2);
@@ -292,10 +314,8 @@ namespace Engine
 
    OperationConstructor(Multiply)
 
-   std::shared_ptr<Types::ValueType> Multiply::evaluate (CallingContext& context) const
+   static std::shared_ptr<Types::ValueType> multiplyValues (const Expression& op, const std::shared_ptr<Types::ValueType>& LHS, const std::shared_ptr<Types::ValueType>& RHS)
     {
-      std::shared_ptr<Types::ValueType> LHS = lhs->evaluate(context);
-      std::shared_ptr<Types::ValueType> RHS = rhs->evaluate(context);
       std::shared_ptr<Types::ValueType> result;
       switch (LHS->getType())
        {
@@ -306,19 +326,19 @@ namespace Engine
             result = std::make_shared<Types::FloatValue>(static_cast<Types::FloatValue*>(LHS.get())->value * static_cast<Types::FloatValue*>(RHS.get())->value);
             break;
          case Types::NIL:
-            result = FLOAT_ZERO();
+            result = Expression::FLOAT_ZERO();
             break;
          case Types::STRING:
          case Types::CELL_REF:
          case Types::CELL_RANGE:
-            constructMessage("Error multiplying " + LHS->getTypeName() + " by " + RHS->getTypeName());
+            op.constructMessage("Error multiplying " + LHS->getTypeName() + " by " + RHS->getTypeName());
           }
          break;
       case Types::NIL:
          switch (RHS->getType())
           {
          case Types::FLOAT:
-            result = FLOAT_ZERO();
+            result = Expression::FLOAT_ZERO();
             break;
          case Types::NIL:
             result = LHS;
@@ -326,17 +346,23 @@ namespace Engine
          case Types::STRING:
          case Types::CELL_REF:
          case Types::CELL_RANGE:
-            constructMessage("Error multiplying " + LHS->getTypeName() + " by " + RHS->getTypeName());
+            op.constructMessage("Error multiplying " + LHS->getTypeName() + " by " + RHS->getTypeName());
           }
          break;
       case Types::STRING:
       case Types::CELL_REF:
       case Types::CELL_RANGE:
-         constructMessage("Error multiplying " + LHS->getTypeName() + " by " + RHS->getTypeName());
+         op.constructMessage("Error multiplying " + LHS->getTypeName() + " by " + RHS->getTypeName());
        }
       return result;
     }
 
+   std::shared_ptr<Types::ValueType> Multiply::evaluate (CallingContext& context) const
+    {
+      std::shared_ptr<Types::ValueType> LHS = lhs->evaluate(context);
+      return multiplyValues(*this, LHS, rhs->evaluate(context));
+    }
+
    std::string Multiply::toString(size_t col, size_t row, int level) const
     {
       return wrapInParens(lhs->toString(col, row, 3) + "*" + rhs->toString(col, row, 3), level, 3);
@@ -544,6 +570,10 @@ namespace Engine
          std::swap(row1, row2);
        }
 
+      if (nullptr != context.theSheet)
+       {
+         context.theSheet->recordRange(context, col1, row1, col2, row2);
+       }
       return std::make_shared<Types::CellRangeValue>(col1, row1, col2, row2);
     }
 
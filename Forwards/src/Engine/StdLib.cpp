@@ -33,10 +33,18 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "Forwards/Engine/Expression.h"
 #include "Forwards/Engine/CallingContext.h"
+#include "Forwards/Engine/SpreadSheet.h"
 
 #include "Forwards/Engine/CellRefEval.h"
+#include "Forwards/Engine/CellRangeExpand.h"
 
+#include "Forwards/Types/FloatValue.h"
+#include "Forwards/Types/CellRangeValue.h"
+
+#include "Backwards/Types/ArrayValue.h"
 #include "Backwards/Types/CellRefValue.h"
+#include "Backwards/Types/CellRangeValue.h"
+#include "Backwards/Types/FloatValue.h"
 #include "Backwards/Types/StringValue.h"
 
 #include "Backwards/Engine/StackFrame.h"
@@ -68,6 +76,10 @@ namespace Engine
                   throw Backwards::Engine::ProgrammingException("Cell Reference wasn't the right Cell Reference.");
                 }
 
+               if (nullptr != text.theSheet)
+                {
+                  text.theSheet->markOrderDependent(text);
+                }
                text.names->insert(std::make_pair(name, last->value));
              }
             else
@@ -87,6 +99,180 @@ namespace Engine
       return first;
     }
 
+      /*
+         The aggregates see the same values, in the same order, as the scripts that they replace:
+         for each argument, a Float counts, a range counts what is in it, and anything else is skipped.
+         A range is read straight out of the sheet, skipping the rows that have no cell.
+      */
+   template <class Visitor>
+   static void visitValue (CallingContext&, const std::shared_ptr<Types::ValueType>&, Visitor&);
+
+   template <class Visitor>
+   static void visitRange (CallingContext& context, const Types::CellRangeValue& range, Visitor& visit)
+    {
+      SpreadSheet* sheet = context.theSheet;
+      if (nullptr == sheet)
+       {
+         throw Backwards::Engine::ProgrammingException("Cell range used without a sheet.");
+       }
+
+         // The range covers the cells that we don't read, too: one that is later filled in must recompute us.
+      sheet->recordRange(context, range.col1, range.row1, range.col2, range.row2);
+
+      for (size_t col = range.col1; (col <= range.col2) && (col < sheet->sheet.size()); ++col)
+       {
+         const Column& column = sheet->sheet[col];
+         for (size_t row = column.next(range.row1); (row <= range.row2) && (row < column.size()); row = column.next(row + 1U))
+          {
+            visitValue(context, sheet->getValueAt(context, column.get(row), col, row), visit);
+          }
+       }
+    }
+
+   template <class Visitor>
+   static void visitValue (CallingContext& context, const std::shared_ptr<Types::ValueType>& value, Visitor& visit)
+    {
+      switch (value->getType())
+       {
+      case Types::FLOAT:
+         visit(static_cast<const Types::FloatValue&>(*value).value);
+         break;
+      case Types::CELL_RANGE:
+         visitRange(context, static_cast<const Types::CellRangeValue&>(*value), visit);
+         break;
+      case Types::CELL_REF:
+         throw Backwards::Engine::ProgrammingException("CellRefEval::evaluate did not resolve to a Backwards Type.");
+      case Types::STRING:
+      case Types::NIL:
+         break;
+       }
+    }
+
+   template <class Visitor>
+   static void visitItem (CallingContext& context, const std::shared_ptr<Backwards::Types::ValueType>& item, Visitor& visit)
+    {
+      if (typeid(Backwards::Types::CellRefValue) == typeid(*item))
+       {
+         const std::shared_ptr<CellRefEval> expr = std::dynamic_pointer_cast<CellRefEval>(static_cast<const Backwards::Types::CellRefValue&>(*item).value);
+         if (nullptr == expr.get())
+          {
+            throw Backwards::Engine::ProgrammingException("CellRefHolder is not a CellRefEval.");
+          }
+         visitValue(context, expr->value->evaluate(context), visit);
+       }
+      else if (typeid(Backwards::Types::FloatValue) == typeid(*item))
+       {
+         visit(static_cast<const Backwards::Types::FloatValue&>(*item).value);
+       }
+      else if (typeid(Backwards::Types::CellRangeValue) == typeid(*item))
+       {
+         const std::shared_ptr<CellRangeExpand> range = std::dynamic_pointer_cast<CellRangeExpand>(static_cast<const Backwards::Types::CellRangeValue&>(*item).value);
+         if (nullptr == range.get())
+          {
+            throw Backwards::Engine::ProgrammingException("CellRangeHolder is not a CellRangeExpand.");
+          }
+         visitRange(context, *range->value, visit);
+       }
+    }
+
+   template <class Visitor>
+   static void visitAll (Backwards::Engine::CallingContext& context, const std::shared_ptr<Backwards::Types::ValueType>& arg, Visitor& visit)
+    {
+      try
+       {
+         CallingContext& text = dynamic_cast<CallingContext&>(context);
+         if (typeid(Backwards::Types::ArrayValue) == typeid(*arg))
+          {
+            for (const std::shared_ptr<Backwards::Types::ValueType>& item : static_cast<const Backwards::Types::ArrayValue&>(*arg).value)
+             {
+               visitItem(text, item, visit);
+             }
+          }
+         else if (typeid(Backwards::Types::CellRangeValue) == typeid(*arg))
+          {
+            visitItem(text, arg, visit);
+          }
+         else
+          {
+            throw Backwards::Types::TypedOperationException("Error iterating over non-Collection.");
+          }
+       }
+      catch (const std::bad_cast&)
+       {
+         throw Backwards::Engine::ProgrammingException("Backwards context wasn't a Forwards context.");
+       }
+    }
+
+   class Summer final
+    {
+   public:
+      BigInt::Fixed_Accumulator sum; // The same as adding them up one at a time, starting from zero.
+      size_t count;
+      Summer() : count(0U) { }
+      void operator() (const BigInt::Fixed& value) { sum += value; ++count; }
+    };
+
+      // Like the Max and Min builtins, the first NaN or Infinity seen wins. Else, of equals, the first seen wins.
+   template <bool max>
+   class Chooser final
+    {
+   public:
+      BigInt::Fixed result;
+      bool found;
+      Chooser() : found(false) { }
+      void operator() (const BigInt::Fixed& value)
+       {
+         if (false == found)
+          {
+            result = value;
+            found = true;
+          }
+         else if ((false == result.isNaN()) && (false == result.isInf()))
+          {
+            if ((true == value.isNaN()) || (true == value.isInf()) || (max ? (value > result) : (value < result)))
+             {
+               result = value;
+             }
+          }
+       }
+    };
+
+   STDLIB_UNARY_DECL_WITH_CONTEXT(CellSum)
+    {
+      Summer visit;
+      visitAll(context, arg, visit);
+      return std::make_shared<Backwards::Types::FloatValue>(visit.sum.get());
+    }
+
+   STDLIB_UNARY_DECL_WITH_CONTEXT(CellCount)
+    {
+      Summer visit;
+      visitAll(context, arg, visit);
+      return std::make_shared<Backwards::Types::FloatValue>(BigInt::Fixed(static_cast<long long>(visit.count), 0U));
+    }
+
+   STDLIB_UNARY_DECL_WITH_CONTEXT(CellAverage)
+    {
+      Summer visit;
+      visitAll(context, arg, visit);
+      return std::make_shared<Backwards::Types::FloatValue>(visit.sum.get() / BigInt::Fixed(static_cast<long long>(visit.count), 0U));
+    }
+
+#define CHOOSERDEFN(x,y) \
+   STDLIB_UNARY_DECL_WITH_CONTEXT(x) \
+    { \
+      Chooser<y> visit; \
+      visitAll(context, arg, visit); \
+      if (false == visit.found) \
+       { \
+         return std::make_shared<Backwards::Types::StringValue>("Empty"); \
+       } \
+      return std::make_shared<Backwards::Types::FloatValue>(visit.result); \
+    }
+
+   CHOOSERDEFN(CellMax, true)
+   CHOOSERDEFN(CellMin, false)
+
    StandardBinaryFunctionWithContext::StandardBinaryFunctionWithContext(BinaryFunctionPointerWithContext function) : Backwards::Engine::Statement(Backwards::Input::Token()), function(function)
     {
     }
@@ -45,8 +45,13 @@ namespace Parser
     {
       Backwards::Parser::ContextBuilder::createGlobalScope(global);
 
-    // 1
+    // 6
       Backwards::Parser::ContextBuilder::addFunction("CellEval", std::make_shared<Backwards::Engine::StandardUnaryFunctionWithContext>(Engine::CellEval), 1U, global);
+      Backwards::Parser::ContextBuilder::addFunction("CellSum", std::make_shared<Backwards::Engine::StandardUnaryFunctionWithContext>(Engine::CellSum), 1U, global);
+      Backwards::Parser::ContextBuilder::addFunction("CellCount", std::make_shared<Backwards::Engine::StandardUnaryFunctionWithContext>(Engine::CellCount), 1U, global);
+      Backwards::Parser::ContextBuilder::addFunction("CellAverage", std::make_shared<Backwards::Engine::StandardUnaryFunctionWithContext>(Engine::CellAverage), 1U, global);
+      Backwards::Parser::ContextBuilder::addFunction("CellMax", std::make_shared<Backwards::Engine::StandardUnaryFunctionWithContext>(Engine::CellMax), 1U, global);
+      Backwards::Parser::ContextBuilder::addFunction("CellMin", std::make_shared<Backwards::Engine::StandardUnaryFunctionWithContext>(Engine::CellMin), 1U, global);
 
     // 1
       Backwards::Parser::ContextBuilder::addFunction("Let", std::make_shared<Forwards::Engine::StandardBinaryFunctionWithContext>(Engine::Let), 2U, global);
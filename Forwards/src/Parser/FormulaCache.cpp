@@ -0,0 +1,127 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Forwards/Parser/FormulaCache.h"
+
+#include "Backwards/Input/StringInput.h"
+
+#include "Forwards/Engine/Expression.h"
+
+#include <algorithm>
+
+namespace Forwards
+ {
+
+namespace Parser
+ {
+
+   static const size_t MIN_PURGE = 1024U;
+
+   FormulaCache::FormulaCache() : nextPurge(MIN_PURGE)
+    {
+    }
+
+   std::shared_ptr<Engine::Expression> FormulaCache::parse(const std::string& input, const Engine::GetterMap& map, Backwards::Engine::Logger& logger, size_t col, size_t row)
+    {
+      std::string key;
+       {
+         Backwards::Input::StringInput interlinked (input);
+         Input::Lexer lexer (interlinked);
+         key = Parser::Normalize(lexer, col, row);
+       }
+
+      if (false == key.empty())
+       {
+         std::lock_guard<std::mutex> guard (lock);
+         std::unordered_map<std::string, std::weak_ptr<Engine::Expression> >::const_iterator found = formulas.find(key);
+         if (formulas.end() != found)
+          {
+            std::shared_ptr<Engine::Expression> result = found->second.lock();
+            if (nullptr != result.get())
+             {
+               return result;
+             }
+          }
+       }
+
+         // Parse without holding the lock: other threads may be parsing, too.
+      Backwards::Input::StringInput interlinked (input);
+      Input::Lexer lexer (interlinked);
+      std::shared_ptr<Engine::Expression> result = Parser::ParseFullExpression(lexer, map, logger, col, row);
+      if ((nullptr == result.get()) || (true == key.empty()))
+       {
+         return result;
+       }
+
+      std::lock_guard<std::mutex> guard (lock);
+      std::weak_ptr<Engine::Expression>& entry = formulas[key];
+      std::shared_ptr<Engine::Expression> other = entry.lock();
+      if (nullptr != other.get()) // Another thread got here first: share its tree.
+       {
+         return other;
+       }
+      entry = result;
+
+      if (formulas.size() >= nextPurge)
+       {
+         for (std::unordered_map<std::string, std::weak_ptr<Engine::Expression> >::iterator iter = formulas.begin(); formulas.end() != iter;)
+          {
+            if (true == iter->second.expired())
+             {
+               iter = formulas.erase(iter);
+             }
+            else
+             {
+               ++iter;
+             }
+          }
+         nextPurge = std::max(MIN_PURGE, formulas.size() * 2U);
+       }
+      return result;
+    }
+
+   size_t FormulaCache::size()
+    {
+      std::lock_guard<std::mutex> guard (lock);
+      size_t result = 0U;
+      for (const std::pair<const std::string, std::weak_ptr<Engine::Expression> >& formula : formulas)
+       {
+         if (false == formula.second.expired())
+          {
+            ++result;
+          }
+       }
+      return result;
+    }
+
+ } // namespace Parser
+
+ } // namespace Forwards
@@ -301,8 +301,16 @@ namespace Parser
 
    std::shared_ptr<Engine::Expression> Parser::cellref (const Input::Token& ref, size_t col, size_t row)
     {
-      bool colAbsolute = false, rowAbsolute = false;
+      bool colAbsolute, rowAbsolute;
       int64_t r_col, r_row;
+      reference(ref, col, row, colAbsolute, r_col, rowAbsolute, r_row);
+      return std::make_shared<Engine::Constant>(ref, std::make_shared<Types::CellRefValue>(colAbsolute, r_col, rowAbsolute, r_row));
+    }
+
+   void Parser::reference (const Input::Token& ref, size_t col, size_t row, bool& colAbsolute, int64_t& r_col, bool& rowAbsolute, int64_t& r_row)
+    {
+      colAbsolute = false;
+      rowAbsolute = false;
       const char * iter = ref.text.c_str();
       if ('$' == *iter)
        {
@@ -338,22 +346,42 @@ namespace Parser
          ++iter;
        }
       r_row = std::atoll(iter) - 1;
-      if (colAbsolute && rowAbsolute)
-       {
-         return std::make_shared<Engine::Constant>(ref, std::make_shared<Types::CellRefValue>(colAbsolute, r_col, rowAbsolute, r_row));
-       }
-      else if (colAbsolute)
+      if (false == colAbsolute)
        {
-         return std::make_shared<Engine::Constant>(ref, std::make_shared<Types::CellRefValue>(colAbsolute, r_col, rowAbsolute, r_row - row));
+         r_col -= col;
        }
-      else if (rowAbsolute)
+      if (false == rowAbsolute)
        {
-         return std::make_shared<Engine::Constant>(ref, std::make_shared<Types::CellRefValue>(colAbsolute, r_col - col, rowAbsolute, r_row));
+         r_row -= row;
        }
-      else
+    }
+
+   std::string Parser::Normalize (Input::Lexer& src, size_t col, size_t row)
+    {
+      std::stringstream str;
+      while (Input::END_OF_FILE != src.peekNextToken().lexeme)
        {
-         return std::make_shared<Engine::Constant>(ref, std::make_shared<Types::CellRefValue>(colAbsolute, r_col - col, rowAbsolute, r_row - row));
+         const Input::Token token = src.getNextToken();
+         if (Input::INVALID == token.lexeme)
+          {
+            return std::string();
+          }
+            // The location is kept, as error messages report it.
+         str << token.lexeme << ' ' << token.location << ' ';
+         if (Input::CELL_REFERENCE == token.lexeme)
+          {
+            bool colAbsolute, rowAbsolute;
+            int64_t r_col, r_row;
+            reference(token, col, row, colAbsolute, r_col, rowAbsolute, r_row);
+            str << (colAbsolute ? 'C' : 'c') << r_col << (rowAbsolute ? 'R' : 'r') << r_row;
+          }
+         else
+          {
+            str << token.text.size() << ':' << token.text;
+          }
+         str << ';';
        }
+      return str.str();
     }
 
  } // namespace Parser
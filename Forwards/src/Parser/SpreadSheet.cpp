@@ -32,17 +32,25 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Forwards/Engine/SpreadSheet.h"
 
 #include "Backwards/Engine/Logger.h"
-#include "Backwards/Input/StringInput.h"
 
 #include "Forwards/Engine/CallingContext.h"
 #include "Forwards/Engine/Cell.h"
 #include "Forwards/Engine/Expression.h"
 
+#include "Forwards/Parser/FormulaCache.h"
 #include "Forwards/Parser/Parser.h"
 #include "Forwards/Parser/StringLogger.h"
 
 #include "Forwards/Types/ValueType.h"
+#include "Forwards/Types/FloatValue.h"
 #include "Forwards/Types/StringValue.h"
+#include "Forwards/Types/NilValue.h"
+#include "Forwards/Types/CellRangeValue.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <thread>
+#include <tuple>
 
 /*
    This is purposely in Parser because it depends on Parser.
@@ -55,18 +63,197 @@ namespace Forwards
 namespace Engine
  {
 
-   SpreadSheet::SpreadSheet() : max_row(0U), c_major(true), top_down(true), left_right(true)
+   /*
+      Parallel recalc:
+      Each thread gets a block of columns, and evaluates its cells in the usual order.
+      A thread evaluates its own cells as usual, but it only reads another thread's cells once they are done:
+      if one isn't, the cell being evaluated is deferred. Rounds are repeated while they make progress,
+      and then whatever is left is evaluated in order on this thread.
+      If anything depends on the order of evaluation, the whole thing is abandoned for an in-order recalc.
+
+      Cancelling:
+      Once cancelled is set, the next cell to be evaluated throws Cancelled instead, and the evaluation unwinds.
+      A cell that was unwound isn't done. A cancelled recalc keeps the cells it finished, and the next update
+      evaluates the rest, and whatever was edited meanwhile (and what depends on it), rather than starting over.
+
+      Long chains:
+      A cell that references a cell that references a cell ... would evaluate the whole chain on the stack.
+      Once cells are nested MAX_NESTING deep, a cell that needs evaluating is instead put on a worklist,
+      and the evaluation is unwound. That cell is evaluated first, and then the cell that needed it is tried again.
+      The cells that were unwound stay marked as in evaluation until then: each of them is waiting on the new cell,
+      so reaching one of them from it is a circular reference, which is handled as it would be on the stack.
+   */
+
+   static const size_t MAX_NESTING = 256U;
+
+   class SpreadSheet::Deferred final
+    {
+   public:
+      Deferred() : waitFor(), local(false) { }
+      explicit Deferred(const CellLocation& waitFor) : waitFor(waitFor), local(true) { }
+
+      CellLocation waitFor; // The cell to evaluate first.
+      bool local; // Else, it is another thread's cell, or the parallel recalc is being abandoned.
+      std::vector<Cell*> unwound; // If local, the cells that were being evaluated: they are still marked as in evaluation.
+    };
+
+   class SpreadSheet::Cancelled final
+    {
+    };
+
+   class SpreadSheet::Worker final
+    {
+   public:
+      Worker(size_t first, size_t last) : first(first), last(last), deferred(0U) { }
+
+      size_t first;
+      size_t last;
+      size_t deferred;
+      std::map<CellLocation, std::vector<CellLocation> > precedents;
+      std::map<CellLocation, std::vector<CellArea> > ranges;
+      Parser::StringLogger logger;
+    };
+
+      /*
+         Which cells have a range over a location, without looking at every range.
+         Each range is split into aligned blocks, whose width and height are powers of two: that is a few blocks
+         for any range, and a location is in just one block of each size. So, a lookup tries each size in use.
+      */
+   class SpreadSheet::RangeIndex final
+    {
+   public:
+      RangeIndex() : colLevels(0U), rowLevels(0U) { }
+
+      void add(const CellLocation& from, const CellArea& area)
+       {
+         for (const Block& block : split(area))
+          {
+            blocks[block].insert(from);
+            colLevels = std::max(colLevels, std::get<0>(block) + 1U);
+            rowLevels = std::max(rowLevels, std::get<2>(block) + 1U);
+          }
+       }
+
+      void remove(const CellLocation& from, const CellArea& area)
+       {
+         for (const Block& block : split(area))
+          {
+            std::map<Block, std::multiset<CellLocation> >::iterator iter = blocks.find(block);
+            if (blocks.end() != iter)
+             {
+               std::multiset<CellLocation>::iterator which = iter->second.find(from);
+               if (iter->second.end() != which)
+                {
+                  iter->second.erase(which);
+                }
+               if (true == iter->second.empty())
+                {
+                  blocks.erase(iter);
+                }
+             }
+          }
+       }
+
+      void clear()
+       {
+         blocks.clear();
+         colLevels = 0U;
+         rowLevels = 0U;
+       }
+
+      void find(const CellLocation& location, std::set<CellLocation>& into) const
+       {
+         if (true == blocks.empty())
+          {
+            return;
+          }
+         for (size_t colLevel = 0U; colLevel < colLevels; ++colLevel)
+          {
+            for (size_t rowLevel = 0U; rowLevel < rowLevels; ++rowLevel)
+             {
+               std::map<Block, std::multiset<CellLocation> >::const_iterator iter =
+                  blocks.find(Block(colLevel, location.first >> colLevel, rowLevel, location.second >> rowLevel));
+               if (blocks.end() != iter)
+                {
+                  into.insert(iter->second.begin(), iter->second.end());
+                }
+             }
+          }
+       }
+
+   private:
+      typedef std::tuple<size_t, size_t, size_t, size_t> Block; // log2 of the width, which column block, then the same for rows
+      std::map<Block, std::multiset<CellLocation> > blocks; // A cell is here once for each of its ranges that has this block.
+      size_t colLevels; // One more than the largest log2 of a width in use
+      size_t rowLevels;
+
+         // Split first to last into the largest aligned blocks that fit: (log2 of the size, which block).
+      static std::vector<std::pair<size_t, size_t> > split(size_t first, size_t last)
+       {
+         std::vector<std::pair<size_t, size_t> > result;
+         for (;;)
+          {
+            size_t level = 0U;
+            while ((level + 2U < sizeof(size_t) * 8U) && (0U == (first & ((static_cast<size_t>(2U) << level) - 1U))) &&
+               (last - first >= (static_cast<size_t>(2U) << level) - 1U))
+             {
+               ++level;
+             }
+            result.emplace_back(level, first >> level);
+            const size_t size = static_cast<size_t>(1U) << level;
+            if (last - first < size)
+             {
+               return result;
+             }
+            first += size;
+          }
+       }
+
+      static std::vector<Block> split(const CellArea& area)
+       {
+         std::vector<Block> result;
+         const std::vector<std::pair<size_t, size_t> > cols = split(area.first.first, area.second.first);
+         const std::vector<std::pair<size_t, size_t> > rows = split(area.first.second, area.second.second);
+         for (const std::pair<size_t, size_t>& col : cols)
+          {
+            for (const std::pair<size_t, size_t>& row : rows)
+             {
+               result.emplace_back(col.first, col.second, row.first, row.second);
+             }
+          }
+         return result;
+       }
+    };
+
+      // The workers' threads are started once, and wait here for each round.
+   class SpreadSheet::Rounds final
+    {
+   public:
+      Rounds() : round(0U), finished(0U), stop(false) { }
+
+      std::mutex lock;
+      std::condition_variable start; // The next round has started, or there are no more.
+      std::condition_variable done; // A worker finished its part of the round.
+      size_t round;
+      size_t finished;
+      bool stop;
+    };
+
+   thread_local SpreadSheet::Worker* SpreadSheet::currentWorker = nullptr;
+   thread_local bool SpreadSheet::suspendable = false;
+
+   SpreadSheet::SpreadSheet() : max_row(0U), c_major(true), top_down(true), left_right(true), threads(1U), cancelled(false), progress(0U), progressTotal(0U), abandonParallel(false), rangeIndex(std::make_unique<RangeIndex>()), graphValid(false), resumable(false), incremental(false), abandon(false), publishAll(false),
+      formulas(std::make_unique<Parser::FormulaCache>())
     {
     }
 
+   SpreadSheet::~SpreadSheet() = default;
+
    Cell* SpreadSheet::getCellAt(size_t col, size_t row)
     {
       if (col < sheet.size())
        {
-         if (row < sheet[col].size())
-          {
-            return sheet[col][row].get();
-          }
+         return sheet[col].get(row);
        }
       return nullptr;
     }
@@ -77,15 +264,12 @@ namespace Engine
        {
          sheet.resize(col + 1U);
        }
-      if (row >= sheet[col].size())
+      if ((row >= sheet[col].size()) && (row >= max_row))
        {
-         sheet[col].resize(row + 1U);
-         if (row >= max_row)
-          {
-            max_row = row + 1;
-          }
+         max_row = row + 1;
        }
-      sheet[col][row] = std::make_unique<Forwards::Engine::Cell>();
+      sheet[col].set(row, std::make_unique<Forwards::Engine::Cell>());
+      markDirty(col, row);
     }
 
    void SpreadSheet::clearCellAt(size_t col, size_t row)
@@ -94,7 +278,8 @@ namespace Engine
        {
          if (row < sheet[col].size())
           {
-            sheet[col][row].reset();
+            sheet[col].reset(row);
+            markDirty(col, row);
           }
        }
     }
@@ -105,35 +290,39 @@ namespace Engine
        {
          sheet[col].clear();
        }
+      markAllDirty();
     }
 
    void SpreadSheet::clearRow(size_t row)
     {
+      markAllDirty();
       for (size_t i = 0U; i < sheet.size(); ++i)
        {
          if (row < sheet[i].size())
           {
-            sheet[i][row].reset();
+            sheet[i].reset(row);
           }
        }
     }
 
    void SpreadSheet::insertColumnBefore(size_t col)
     {
+      markAllDirty(); // Moving cells invalidates every recorded reference.
       if (col < sheet.size())
        {
-         sheet.insert(sheet.begin() + col, std::vector<std::unique_ptr<Cell> >());
+         sheet.insert(sheet.begin() + col, Column());
        }
     }
 
    void SpreadSheet::insertRowBefore(size_t row)
     {
+      markAllDirty();
       bool didAnything = false;
       for (size_t i = 0U; i < sheet.size(); ++i)
        {
          if (row < sheet[i].size())
           {
-            sheet[i].insert(sheet[i].begin() + row, std::unique_ptr<Cell>());
+            sheet[i].insert(row);
             didAnything = true;
           }
        }
@@ -154,20 +343,15 @@ namespace Engine
           {
             sheet.resize(col2 + 1U);
           }
-         if (row >= sheet[col1].size())
-          {
-            sheet[col1].resize(row + 1U);
-          }
-         if (row >= sheet[col2].size())
-          {
-            sheet[col2].resize(row + 1U);
-          }
-         sheet[col1][row].swap(sheet[col2][row]);
+         std::unique_ptr<Cell> temp = sheet[col1].take(row);
+         sheet[col1].set(row, sheet[col2].take(row));
+         sheet[col2].set(row, std::move(temp));
        }
     }
 
    void SpreadSheet::insertCellBeforeShiftRight(size_t col, size_t row)
     {
+      markAllDirty();
       // Bubble in an empty cell from the far right.
       for (size_t i = sheet.size(); i > col; --i)
        {
@@ -177,6 +361,7 @@ namespace Engine
 
    void SpreadSheet::insertCellBeforeShiftDown(size_t col, size_t row)
     {
+      markAllDirty();
       if (col < sheet.size())
        {
          if (row < sheet[col].size())
@@ -185,13 +370,14 @@ namespace Engine
              {
                ++max_row;
              }
-            sheet[col].insert(sheet[col].begin() + row, std::unique_ptr<Cell>());
+            sheet[col].insert(row);
           }
        }
     }
 
    void SpreadSheet::removeColumn(size_t col)
     {
+      markAllDirty();
       if (col < sheet.size())
        {
          sheet.erase(sheet.begin() + col);
@@ -200,17 +386,19 @@ namespace Engine
 
    void SpreadSheet::removeRow(size_t row)
     {
+      markAllDirty();
       for (size_t i = 0U; i < sheet.size(); ++i)
        {
          if (row < sheet[i].size())
           {
-            sheet[i].erase(sheet[i].begin() + row);
+            sheet[i].erase(row);
           }
        }
     }
 
    void SpreadSheet::removeCellShiftLeft(size_t col, size_t row)
     {
+      markAllDirty();
       // Clear the cell and bubble it out to the far right.
       clearCellAt(col, row);
       for (size_t i = col; i < sheet.size(); ++i) // Don't optimize to sheet.size() - 1
@@ -221,11 +409,12 @@ namespace Engine
 
    void SpreadSheet::removeCellShiftUp(size_t col, size_t row)
     {
+      markAllDirty();
       if (col < sheet.size())
        {
          if (row < sheet[col].size())
           {
-            sheet[col].erase(sheet[col].begin() + row);
+            sheet[col].erase(row);
           }
        }
     }
@@ -235,6 +424,7 @@ namespace Engine
     {
       std::string result;
       OUT.reset(); // Ensure to clear OUT variable.
+      BigInt::Fixed_Context_Holder hold (context.numeric);
 
       Cell* cell = getCellAt(col, row);
       if (nullptr == cell)
@@ -259,13 +449,8 @@ namespace Engine
          // Else, this is a VALUE, and we need to parse it.
       if (nullptr == value.get())
        {
-         Backwards::Input::StringInput interlinked (cell->currentInput);
-         Input::Lexer lexer (interlinked);
-         Backwards::Engine::Logger* temp = context.logger;
          Parser::StringLogger newLogger;
-         context.logger = &newLogger;
-         value = Parser::Parser::ParseFullExpression(lexer, *context.map, *context.logger, col, row);
-         context.logger = temp;
+         value = formulas->parse(cell->currentInput, *context.map, newLogger, col, row);
          if (newLogger.logs.size() > 0U)
           {
             result = newLogger.logs[0U];
@@ -279,12 +464,18 @@ namespace Engine
        }
 
          // If this is a regular update, update the cell. Eww....
-      if (false == context.inUserInput)
+      if ((false == context.inUserInput) && ((value != cell->value) || (false == cell->currentInput.empty())))
        {
+         std::lock_guard<std::mutex> guard (snapshotLock);
          cell->currentInput = "";
          cell->value = value;
        }
 
+      const CellLocation location (col, row);
+      const std::shared_ptr<Types::ValueType> oldValue = cell->previousValue;
+      const BigInt::Fixed_Context numbers = BigInt::Fixed::getContext();
+      startEvaluation(context, location);
+
       try
        {
          context.pushCell(&newFrame);
@@ -293,16 +484,16 @@ namespace Engine
          context.topCell()->cell->recursed = false;
          OUT = value->evaluate(context);
          context.topCell()->cell->inEvaluation = false;
-         context.topCell()->cell->previousGeneration = context.generation;
          context.topCell()->cell->previousValue = OUT;
+         context.topCell()->cell->previousGeneration = context.generation;
          context.popCell();
        }
       catch (const std::exception& e)
        {
          result = e.what();
          context.topCell()->cell->inEvaluation = false;
-         context.topCell()->cell->previousGeneration = context.generation;
          context.topCell()->cell->previousValue = OUT;
+         context.topCell()->cell->previousGeneration = context.generation;
          context.popCell();
        }
       catch (...)
@@ -311,6 +502,13 @@ namespace Engine
          context.popCell();
        }
 
+      finishEvaluation(context, cell, location, oldValue, numbers != BigInt::Fixed::getContext());
+
+      if (false == context.inUserInput) // Don't let user input change the sheet's context.
+       {
+         context.numeric = BigInt::Fixed::getContext();
+       }
+
       size_t c = result.find('\n');
       if (std::string::npos != c)
        {
@@ -337,6 +535,18 @@ namespace Engine
          return cell->previousValue;
        }
 
+         // Stop at this cell, if we were asked to.
+      if ((false == context.inUserInput) && (true == cancelled))
+       {
+         throw Cancelled();
+       }
+
+         // If the stack is getting deep, then evaluate this cell from the worklist instead.
+      if ((true == suspendable) && (context.depth() >= MAX_NESTING))
+       {
+         throw Deferred(CellLocation(col, row));
+       }
+
          // If this is a LABEL, then set the value.
       std::shared_ptr<Expression> value = cell->value;
       if ((LABEL == cell->type) && (nullptr == value.get()))
@@ -346,13 +556,8 @@ namespace Engine
          // Else, this is a VALUE, and we need to parse it.
       if (nullptr == value.get())
        {
-         Backwards::Input::StringInput interlinked (cell->currentInput);
-         Input::Lexer lexer (interlinked);
-         Backwards::Engine::Logger* temp = context.logger;
          Parser::StringLogger newLogger;
-         context.logger = &newLogger;
-         value = Parser::Parser::ParseFullExpression(lexer, *context.map, *context.logger, col, row);
-         context.logger = temp;
+         value = formulas->parse(cell->currentInput, *context.map, newLogger, col, row);
        }
 
          // If the parse failed, leave. Result will have the first parser message.
@@ -362,66 +567,253 @@ namespace Engine
        }
 
          // If this is a regular update, update the cell. Eww....
-      if (false == context.inUserInput)
+      if ((false == context.inUserInput) && ((value != cell->value) || (false == cell->currentInput.empty())))
        {
+         std::lock_guard<std::mutex> guard (snapshotLock);
          cell->currentInput = "";
          cell->value = value;
        }
 
+      const CellLocation location (col, row);
+      const std::shared_ptr<Types::ValueType> oldValue = cell->previousValue;
+      const BigInt::Fixed_Context numbers = BigInt::Fixed::getContext();
+      const bool resumed = cell->waiting; // Then, a circular reference found while it waited still counts.
+      cell->waiting = false;
+      startEvaluation(context, location);
+
       try
        {
          context.pushCell(&newFrame);
             // Evaluate the new cell.
          context.topCell()->cell->inEvaluation = true;
-         context.topCell()->cell->recursed = false;
+         if (false == resumed)
+          {
+            context.topCell()->cell->recursed = false;
+          }
          OUT = value->evaluate(context);
          context.topCell()->cell->inEvaluation = false;
-         context.topCell()->cell->previousGeneration = context.generation;
          context.topCell()->cell->previousValue = OUT;
+         context.topCell()->cell->previousGeneration = context.generation;
+         context.popCell();
+       }
+      catch (Deferred& wait)
+       {
+         if (true == wait.local) // It waits, still in evaluation, for the deferred cell.
+          {
+            cell->waiting = true;
+            wait.unwound.push_back(cell);
+          }
+         else
+          {
+            cell->inEvaluation = false;
+          }
+         context.popCell();
+         throw;
+       }
+      catch (const Cancelled&)
+       {
+         context.topCell()->cell->inEvaluation = false;
          context.popCell();
+         throw;
        }
       catch (...)
        {
          context.topCell()->cell->inEvaluation = false;
-         context.topCell()->cell->previousGeneration = context.generation;
          context.topCell()->cell->previousValue = OUT;
+         context.topCell()->cell->previousGeneration = context.generation;
          context.popCell();
+         finishEvaluation(context, cell, location, oldValue, numbers != BigInt::Fixed::getContext());
          if (true == rethrow)
           {
             throw;
           }
        }
 
+      finishEvaluation(context, cell, location, oldValue, numbers != BigInt::Fixed::getContext());
       return OUT;
     }
 
 
+   std::shared_ptr<Types::ValueType> SpreadSheet::getValueAt(CallingContext& context, Cell* cell, size_t col, size_t row)
+    {
+         // If no cell, Nil.
+      if (nullptr == cell)
+       {
+         return std::make_shared<Types::NilValue>();
+       }
+
+         // In a parallel recalc, another thread's cell can only be read once it is done.
+      std::shared_ptr<Types::ValueType> result;
+      if (true == readOtherThread(context, cell, col, result))
+       {
+         if (nullptr == result.get())
+          {
+            result = std::make_shared<Types::NilValue>();
+          }
+         return result;
+       }
+
+         // If we are currently evaluating this cell, stop.
+      if (true == cell->inEvaluation)
+       {
+         result = cell->previousValue;
+         if (nullptr == result.get())
+          {
+            result = std::make_shared<Types::NilValue>();
+          }
+         cell->recursed = true;
+         return result;
+       }
+
+         // Guess we need to do work.
+      result = computeCell(context, col, row, true);
+      if (nullptr == result.get())
+       {
+         result = std::make_shared<Types::NilValue>();
+       }
+      return result;
+    }
+
+
+   typedef std::vector<std::pair<CellLocation, Cell*> > ParseList;
+
+   static void parseCells(Parser::FormulaCache& formulas, const GetterMap& map, const ParseList& work, size_t first, size_t last, std::map<CellLocation, std::string>& errors)
+    {
+      for (size_t i = first; i < last; ++i)
+       {
+         const CellLocation& location = work[i].first;
+         Cell* cell = work[i].second;
+         Parser::StringLogger logger;
+         std::shared_ptr<Expression> value = formulas.parse(cell->currentInput, map, logger, location.first, location.second);
+         if (nullptr != value.get())
+          {
+            cell->currentInput = "";
+            cell->value = value;
+          }
+         else
+          {
+            std::string message = (logger.logs.size() > 0U) ? logger.logs[0U] : std::string();
+            size_t c = message.find('\n');
+            if (std::string::npos != c)
+             {
+               message.resize(c);
+             }
+            errors.emplace(location, message);
+          }
+       }
+    }
+
+   std::map<CellLocation, std::string> SpreadSheet::parseAll(CallingContext& context)
+    {
+      ParseList work;
+      for (size_t col = 0U; col < sheet.size(); ++col)
+       {
+         for (size_t row = sheet[col].next(0U); row < sheet[col].size(); row = sheet[col].next(row + 1U))
+          {
+            Cell* cell = sheet[col].get(row);
+            if ((VALUE == cell->type) && (nullptr == cell->value.get()))
+             {
+               work.emplace_back(CellLocation(col, row), cell);
+             }
+          }
+       }
+
+         // Each thread takes a contiguous share of the formulas, and this thread takes the first.
+      const size_t count = std::max(static_cast<size_t>(1U), std::min(threads, work.size()));
+      std::vector<std::map<CellLocation, std::string> > errors (count);
+      std::vector<std::thread> pool;
+      for (size_t i = 1U; i < count; ++i)
+       {
+         pool.emplace_back(parseCells, std::ref(*formulas), std::cref(*context.map), std::cref(work), work.size() * i / count, work.size() * (i + 1U) / count, std::ref(errors[i]));
+       }
+      parseCells(*formulas, *context.map, work, 0U, work.size() / count, errors[0U]);
+      for (std::thread& thread : pool)
+       {
+         thread.join();
+       }
+
+      for (size_t i = 1U; i < count; ++i)
+       {
+         errors[0U].insert(errors[i].begin(), errors[i].end());
+       }
+      return errors[0U];
+    }
+
+
    void SpreadSheet::recalc(CallingContext& context)
+    {
+      BigInt::Fixed_Context_Holder hold (context.numeric);
+
+         // A sheet that depended on the order of evaluation last time probably will again.
+      bool done = false;
+      if ((threads > 1U) && (sheet.size() > 1U) && (true == orderDependent.empty()) && (nullptr == context.debugger))
+       {
+         startRecalc(context);
+         done = recalcInParallel(context);
+       }
+      if (false == done)
+       {
+         startRecalc(context);
+         evaluateInOrder(context, 0U, sheet.size());
+       }
+      ++context.generation;
+      finishRecalc();
+      context.numeric = BigInt::Fixed::getContext();
+
+         // The workers' spare number storage went away with them: let this thread's go, too.
+      BigInt::releasePooledMemory();
+    }
+
+   void SpreadSheet::startRecalc(CallingContext& context)
     {
       context.inUserInput = false;
       ++context.generation;
       context.names->clear();
+      (void) BigInt::Fixed::setContext(context.numeric);
+
+         // Every cell is about to be evaluated, and will record its references anew.
+      dependents.clear();
+      precedents.clear();
+      ranges.clear();
+      rangeIndex->clear();
+      orderDependent.clear();
+      dirty.clear();
+      graphValid = true;
+      resumable = false;
+      publishAll = true;
+
+      size_t total = 0U;
+      for (const Column& column : sheet)
+       {
+         total += column.count();
+       }
+      progress = 0U;
+      progressTotal = total;
+    }
+
+   void SpreadSheet::evaluateInOrder(CallingContext& context, size_t firstCol, size_t lastCol)
+    {
       if (c_major) // Going in column-major order
        {
          if (left_right) // Going from left-to-right
           {
             if (top_down) // Going from top-to-bottom
              {
-               for (size_t col = 0U; col < sheet.size(); ++col)
+               for (size_t col = firstCol; col < lastCol; ++col)
                 {
-                  for (size_t row = 0U; row < sheet[col].size(); ++row)
+                  for (size_t row = sheet[col].next(0U); row < sheet[col].size(); row = sheet[col].next(row + 1U))
                    {
-                     (void) computeCell(context, col, row, false);
+                     evaluateOne(context, col, row);
                    }
                 }
              }
             else // Going from bottom-to-top
              {
-               for (size_t col = 0U; col < sheet.size(); ++col)
+               for (size_t col = firstCol; col < lastCol; ++col)
                 {
-                  for (size_t row = sheet[col].size() - 1U; row != (static_cast<size_t>(0U) - 1U); --row)
+                  for (size_t row = sheet[col].previous(sheet[col].size()); row != Column::NONE; row = sheet[col].previous(row))
                    {
-                     (void) computeCell(context, col, row, false);
+                     evaluateOne(context, col, row);
                    }
                 }
              }
@@ -430,21 +822,21 @@ namespace Engine
           {
             if (top_down) // Going from top-to-bottom
              {
-               for (size_t col = sheet.size() - 1U; col != (static_cast<size_t>(0U) - 1U); --col)
+               for (size_t col = lastCol - 1U; col != (firstCol - 1U); --col)
                 {
-                  for (size_t row = 0U; row < sheet[col].size(); ++row)
+                  for (size_t row = sheet[col].next(0U); row < sheet[col].size(); row = sheet[col].next(row + 1U))
                    {
-                     (void) computeCell(context, col, row, false);
+                     evaluateOne(context, col, row);
                    }
                 }
              }
             else // Going from bottom-to-top
              {
-               for (size_t col = sheet.size() - 1U; col != (static_cast<size_t>(0U) - 1U); --col)
+               for (size_t col = lastCol - 1U; col != (firstCol - 1U); --col)
                 {
-                  for (size_t row = sheet[col].size() - 1U; row != (static_cast<size_t>(0U) - 1U); --row)
+                  for (size_t row = sheet[col].previous(sheet[col].size()); row != Column::NONE; row = sheet[col].previous(row))
                    {
-                     (void) computeCell(context, col, row, false);
+                     evaluateOne(context, col, row);
                    }
                 }
              }
@@ -456,21 +848,21 @@ namespace Engine
           {
             if (left_right) // Going from left-to-right
              {
-               for (size_t row = 0U; row < max_row; ++row)
+               for (size_t row = nextRow(firstCol, lastCol, 0U); row < max_row; row = nextRow(firstCol, lastCol, row + 1U))
                 {
-                  for (size_t col = 0U; col < sheet.size(); ++col)
+                  for (size_t col = firstCol; col < lastCol; ++col)
                    {
-                     (void) computeCell(context, col, row, false);
+                     evaluateOne(context, col, row);
                    }
                 }
              }
             else // Going from right-to-left
              {
-               for (size_t row = max_row - 1U; row != (static_cast<size_t>(0U) - 1U); --row)
+               for (size_t row = previousRow(firstCol, lastCol, max_row); row != Column::NONE; row = previousRow(firstCol, lastCol, row))
                 {
-                  for (size_t col = 0U; col < sheet.size(); ++col)
+                  for (size_t col = firstCol; col < lastCol; ++col)
                    {
-                     (void) computeCell(context, col, row, false);
+                     evaluateOne(context, col, row);
                    }
                 }
              }
@@ -479,27 +871,713 @@ namespace Engine
           {
             if (left_right) // Going from left-to-right
              {
-               for (size_t row = 0U; row < max_row; ++row)
+               for (size_t row = nextRow(firstCol, lastCol, 0U); row < max_row; row = nextRow(firstCol, lastCol, row + 1U))
                 {
-                  for (size_t col = sheet.size() - 1U; col != (static_cast<size_t>(0U) - 1U); --col)
+                  for (size_t col = lastCol - 1U; col != (firstCol - 1U); --col)
                    {
-                     (void) computeCell(context, col, row, false);
+                     evaluateOne(context, col, row);
                    }
                 }
              }
             else // Going from right-to-left
              {
-               for (size_t row = max_row - 1U; row != (static_cast<size_t>(0U) - 1U); --row)
+               for (size_t row = previousRow(firstCol, lastCol, max_row); row != Column::NONE; row = previousRow(firstCol, lastCol, row))
                 {
-                  for (size_t col = sheet.size() - 1U; col != (static_cast<size_t>(0U) - 1U); --col)
+                  for (size_t col = lastCol - 1U; col != (firstCol - 1U); --col)
                    {
-                     (void) computeCell(context, col, row, false);
+                     evaluateOne(context, col, row);
                    }
                 }
              }
           }
        }
+    }
+
+   size_t SpreadSheet::nextRow(size_t firstCol, size_t lastCol, size_t row) const
+    {
+      size_t result = max_row;
+      for (size_t col = firstCol; col < lastCol; ++col)
+       {
+         const size_t found = sheet[col].next(row);
+         if ((found < sheet[col].size()) && (found < result))
+          {
+            result = found;
+          }
+       }
+      return result;
+    }
+
+   size_t SpreadSheet::previousRow(size_t firstCol, size_t lastCol, size_t row) const
+    {
+      size_t result = Column::NONE;
+      for (size_t col = firstCol; col < lastCol; ++col)
+       {
+         const size_t found = sheet[col].previous(row);
+         if ((Column::NONE != found) && ((Column::NONE == result) || (found > result)))
+          {
+            result = found;
+          }
+       }
+      return result;
+    }
+
+   void SpreadSheet::evaluateOne(CallingContext& context, size_t col, size_t row)
+    {
+         // The cells waiting on another cell, with the next to evaluate at the back,
+         // and for each, the cells that it left in evaluation when it was unwound.
+      std::vector<CellLocation> work (1U, CellLocation(col, row));
+      std::vector<std::vector<Cell*> > unwound (1U);
+      std::vector<Cell*> resumed; // Every cell that was unwound, to tidy up after.
+      const bool wasSuspendable = suspendable;
+      suspendable = true;
+      while (false == work.empty())
+       {
+         if (((nullptr != currentWorker) && (true == abandonParallel)) || (true == cancelled))
+          {
+            break;
+          }
+         try
+          {
+               // What this cell waited on is done: it can go through the cells that it left in evaluation again.
+            for (Cell* cell : unwound.back())
+             {
+               cell->inEvaluation = false;
+               resumed.push_back(cell);
+             }
+            unwound.back().clear();
+
+            const CellLocation location = work.back();
+            (void) computeCell(context, location.first, location.second, false);
+            work.pop_back();
+            unwound.pop_back();
+          }
+         catch (Deferred& wait)
+          {
+            if (false == wait.local)
+             {
+               ++currentWorker->deferred;
+               break;
+             }
+            unwound.back() = std::move(wait.unwound);
+            work.push_back(wait.waitFor);
+            unwound.emplace_back();
+          }
+         catch (const Cancelled&) // Leave the rest: the cells that weren't finished aren't done.
+          {
+            break;
+          }
+       }
+
+         // If we stopped early, nothing is waiting anymore.
+      for (const std::vector<Cell*>& list : unwound)
+       {
+         for (Cell* cell : list)
+          {
+            cell->inEvaluation = false;
+            cell->waiting = false;
+          }
+       }
+      for (Cell* cell : resumed)
+       {
+         cell->waiting = false;
+       }
+      suspendable = wasSuspendable;
+    }
+
+   bool SpreadSheet::recalcInParallel(CallingContext& context)
+    {
+         // Split the columns into blocks of about the same number of cells.
+      size_t total = 0U;
+      for (const Column& column : sheet)
+       {
+         total += column.count();
+       }
+      const size_t target = total / threads + 1U;
+
+      std::vector<Worker> workers;
+      size_t first = 0U;
+      size_t count = 0U;
+      for (size_t col = 0U; col < sheet.size(); ++col)
+       {
+         count += sheet[col].count();
+         if ((count >= target) || ((col + 1U) == sheet.size()))
+          {
+            workers.emplace_back(first, col + 1U);
+            first = col + 1U;
+            count = 0U;
+          }
+       }
+      if (workers.size() < 2U)
+       {
+         return false;
+       }
+
+      abandonParallel = false;
+      Rounds rounds;
+      std::vector<std::thread> pool;
+      for (Worker& worker : workers)
+       {
+         pool.emplace_back(&SpreadSheet::work, this, std::ref(context), std::ref(worker), std::ref(rounds));
+       }
+
+      size_t lastDeferred = total + 1U;
+      for (;;)
+       {
+          {
+            std::unique_lock<std::mutex> guard (rounds.lock);
+            rounds.finished = 0U;
+            ++rounds.round;
+            rounds.start.notify_all();
+            while (rounds.finished < workers.size())
+             {
+               rounds.done.wait(guard);
+             }
+          }
+
+         size_t deferred = 0U;
+         for (const Worker& worker : workers)
+          {
+            deferred += worker.deferred;
+          }
+         if ((true == abandonParallel) || (0U == deferred) || (deferred >= lastDeferred))
+          {
+            break;
+          }
+         lastDeferred = deferred;
+       }
+
+       {
+         std::lock_guard<std::mutex> guard (rounds.lock);
+         rounds.stop = true;
+         rounds.start.notify_all();
+       }
+      for (std::thread& thread : pool)
+       {
+         thread.join();
+       }
+
+      if (true == abandonParallel)
+       {
+         return false;
+       }
+
+      for (Worker& worker : workers)
+       {
+         for (const std::pair<const CellLocation, std::vector<CellLocation> >& item : worker.precedents)
+          {
+            for (const CellLocation& to : item.second)
+             {
+               if (true == dependents[to].insert(item.first).second)
+                {
+                  precedents[item.first].push_back(to);
+                }
+             }
+          }
+         for (std::pair<const CellLocation, std::vector<CellArea> >& item : worker.ranges)
+          {
+            std::vector<CellArea>& into = ranges[item.first];
+            into.insert(into.end(), item.second.begin(), item.second.end());
+            for (const CellArea& area : item.second)
+             {
+               rangeIndex->add(item.first, area);
+             }
+          }
+         if (nullptr != context.logger)
+          {
+            for (const std::string& message : worker.logger.logs)
+             {
+               context.logger->log(message);
+             }
+          }
+       }
+
+      evaluateInOrder(context, 0U, sheet.size()); // Whatever is left.
+      return orderDependent.empty();
+    }
+
+   void SpreadSheet::work(CallingContext& context, Worker& worker, Rounds& rounds)
+    {
+      CallingContext local;
+      local.logger = &worker.logger;
+      local.globalScope = context.globalScope;
+      if (nullptr != context.topScope())
+       {
+         local.pushScope(context.topScope());
+       }
+      local.generation = context.generation;
+      local.theSheet = this;
+      local.map = context.map;
+      local.names = context.names;
+      local.numeric = context.numeric;
+      BigInt::Fixed_Context_Holder hold (local.numeric);
+
+      currentWorker = &worker;
+      size_t round = 0U;
+      for (;;)
+       {
+          {
+            std::unique_lock<std::mutex> guard (rounds.lock);
+            while ((round == rounds.round) && (false == rounds.stop))
+             {
+               rounds.start.wait(guard);
+             }
+            if (true == rounds.stop)
+             {
+               break;
+             }
+            round = rounds.round;
+          }
+
+         worker.deferred = 0U;
+         evaluateInOrder(local, worker.first, worker.last);
+
+          {
+            std::lock_guard<std::mutex> guard (rounds.lock);
+            ++rounds.finished;
+            rounds.done.notify_one();
+          }
+       }
+      currentWorker = nullptr;
+    }
+
+   bool SpreadSheet::readOtherThread(CallingContext& context, Cell* cell, size_t col, std::shared_ptr<Types::ValueType>& OUT)
+    {
+      if ((nullptr == currentWorker) || ((col >= currentWorker->first) && (col < currentWorker->last)))
+       {
+         return false;
+       }
+      if (context.generation != cell->previousGeneration)
+       {
+         throw Deferred();
+       }
+      OUT = cell->previousValue;
+      return true;
+    }
+
+   static bool inArea(const CellArea& area, const CellLocation& location)
+    {
+      return (location.first >= area.first.first) && (location.first <= area.second.first) &&
+         (location.second >= area.first.second) && (location.second <= area.second.second);
+    }
+
+      // Would a cell that used the old value compute the same thing with the new one?
+      // FLOATs must agree on scale as well as value, as the scale carries into later arithmetic.
+   static bool sameValue(const std::shared_ptr<Types::ValueType>& lhs, const std::shared_ptr<Types::ValueType>& rhs)
+    {
+      if ((nullptr == lhs.get()) || (nullptr == rhs.get()))
+       {
+         return lhs.get() == rhs.get();
+       }
+      if (lhs->getType() != rhs->getType())
+       {
+         return false;
+       }
+      switch (lhs->getType())
+       {
+      case Types::FLOAT:
+       {
+         const BigInt::Fixed& left = static_cast<const Types::FloatValue&>(*lhs).value;
+         const BigInt::Fixed& right = static_cast<const Types::FloatValue&>(*rhs).value;
+         if (left.isNaN() || right.isNaN() || left.isInf() || right.isInf())
+          {
+            return false;
+          }
+         return (left.getPrecision() == right.getPrecision()) && (left == right);
+       }
+      case Types::STRING:
+         return static_cast<const Types::StringValue&>(*lhs).value == static_cast<const Types::StringValue&>(*rhs).value;
+      case Types::NIL:
+         return true;
+      case Types::CELL_RANGE:
+       {
+         const Types::CellRangeValue& left = static_cast<const Types::CellRangeValue&>(*lhs);
+         const Types::CellRangeValue& right = static_cast<const Types::CellRangeValue&>(*rhs);
+         return (left.col1 == right.col1) && (left.row1 == right.row1) && (left.col2 == right.col2) && (left.row2 == right.row2);
+       }
+      default:
+         return false;
+       }
+    }
+
+   void SpreadSheet::recordReference(CallingContext& context, size_t col, size_t row)
+    {
+      CellFrame* frame = context.topCell();
+      if ((true == context.inUserInput) || (nullptr == frame) || (nullptr == frame->cell))
+       {
+         return;
+       }
+      const CellLocation from (frame->col, frame->row);
+      const CellLocation to (col, row);
+
+         // Don't record the cells of a range one at a time: the range covers them.
+      std::map<CellLocation, std::vector<CellArea> >& areas = (nullptr == currentWorker) ? ranges : currentWorker->ranges;
+      std::map<CellLocation, std::vector<CellArea> >::const_iterator area = areas.find(from);
+      if (areas.end() != area)
+       {
+         for (const CellArea& item : area->second)
+          {
+            if (true == inArea(item, to))
+             {
+               return;
+             }
+          }
+       }
+
+      if (nullptr != currentWorker) // The dependents are filled in once the threads are done.
+       {
+         std::vector<CellLocation>& list = currentWorker->precedents[from];
+         if (list.end() == std::find(list.begin(), list.end(), to))
+          {
+            list.push_back(to);
+          }
+       }
+      else if (true == dependents[to].insert(from).second)
+       {
+         precedents[from].push_back(to);
+       }
+    }
+
+   void SpreadSheet::recordRange(CallingContext& context, size_t col1, size_t row1, size_t col2, size_t row2)
+    {
+      CellFrame* frame = context.topCell();
+      if ((true == context.inUserInput) || (nullptr == frame) || (nullptr == frame->cell))
+       {
+         return;
+       }
+      std::map<CellLocation, std::vector<CellArea> >& areas = (nullptr == currentWorker) ? ranges : currentWorker->ranges;
+      const CellLocation from (frame->col, frame->row);
+      std::vector<CellArea>& list = areas[from];
+      const CellArea area (CellLocation(col1, row1), CellLocation(col2, row2));
+      if (list.end() == std::find(list.begin(), list.end(), area)) // A range is recorded again when it is summed over.
+       {
+         list.push_back(area);
+         if (nullptr == currentWorker) // A worker's ranges are indexed once the threads are done.
+          {
+            rangeIndex->add(from, area);
+          }
+       }
+    }
+
+   void SpreadSheet::markOrderDependent(CallingContext& context)
+    {
+      CellFrame* frame = context.topCell();
+      if ((true == context.inUserInput) || (nullptr == frame) || (nullptr == frame->cell))
+       {
+         return;
+       }
+      if (nullptr != currentWorker) // Stop before the side effect happens.
+       {
+         abandonParallel = true;
+         throw Deferred();
+       }
+      orderDependent.insert(CellLocation(frame->col, frame->row));
+    }
+
+   void SpreadSheet::markDirty(size_t col, size_t row)
+    {
+      dirty.insert(CellLocation(col, row));
+    }
+
+   void SpreadSheet::markAllDirty()
+    {
+      graphValid = false;
+      resumable = false;
+    }
+
+   void SpreadSheet::finishRecalc()
+    {
+      if (false == cancelled)
+       {
+         publish();
+       }
+      else if (true == orderDependent.empty())
+       {
+         resumable = true;
+         graphValid = false; // Until the rest is evaluated.
+       }
+      else // Some cells weren't evaluated, and what they did in order won't be done the same way again.
+       {
+         graphValid = false;
+       }
+    }
+
+   void SpreadSheet::resumeRecalc(CallingContext& context)
+    {
+      BigInt::Fixed_Context_Holder hold (context.numeric);
+      context.inUserInput = false;
+      --context.generation; // Return to the generation of the cancelled recalc: what it finished is done.
+
+         // What was edited since, and everything that was computed from it, is done no longer.
+      std::vector<CellLocation> work (dirty.begin(), dirty.end());
+      std::set<CellLocation> seen (dirty.begin(), dirty.end());
+      const bool edited = !dirty.empty();
+      dirty.clear();
+      while (false == work.empty())
+       {
+         const CellLocation location = work.back();
+         work.pop_back();
+         Cell* cell = getCellAt(location.first, location.second);
+         if (nullptr != cell)
+          {
+            cell->previousGeneration = 0U;
+          }
+         std::vector<CellLocation> from;
+         dependentsOf(location, from);
+         for (const CellLocation& next : from)
+          {
+            if (true == seen.insert(next).second)
+             {
+               work.push_back(next);
+             }
+          }
+       }
+
+      size_t total = 0U;
+      size_t done = 0U;
+      for (const Column& column : sheet)
+       {
+         total += column.count();
+         for (size_t row = column.next(0U); row < column.size(); row = column.next(row + 1U))
+          {
+            if (context.generation == column.get(row)->previousGeneration)
+             {
+               ++done;
+             }
+          }
+       }
+      progress = done;
+      progressTotal = total;
+
+      resumable = false;
+      graphValid = true;
+      evaluateInOrder(context, 0U, sheet.size());
+      ++context.generation;
+      context.numeric = BigInt::Fixed::getContext();
+
+         // A cell that depends on the order of evaluation may have seen an edited cell out of order.
+      if ((false == cancelled) && (true == edited) && (false == orderDependent.empty()))
+       {
+         recalc(context);
+         return;
+       }
+      finishRecalc();
+
+      BigInt::releasePooledMemory();
+    }
+
+   void SpreadSheet::update(CallingContext& context)
+    {
+      if (true == resumable)
+       {
+         resumeRecalc(context);
+         return;
+       }
+
+         // If any cell depends on the order of evaluation (it recursed, changed the scale or rounding mode, or named something),
+         // then only evaluating the sheet in its proper order gives the right answer.
+      if ((false == graphValid) || (false == orderDependent.empty()))
+       {
+         recalc(context);
+         return;
+       }
+
+      BigInt::Fixed_Context_Holder hold (context.numeric);
+      context.inUserInput = false;
+      --context.generation; // Return to the generation of the last recalc: everything not scheduled is current.
+      incremental = true;
+      abandon = false;
+
+      for (const CellLocation& location : dirty)
+       {
+         if (nullptr != getCellAt(location.first, location.second))
+          {
+            schedule(location); // Its dependents are scheduled if its value changes.
+          }
+         else
+          {
+            scheduleDependents(location);
+          }
+       }
+      dirty.clear();
+      progress = 0U;
+
+         // Evaluating a cell will evaluate the stale cells it references, so order is only a nicety.
+      while ((false == pending.empty()) && (false == abandon) && (false == cancelled))
+       {
+         progressTotal = progress + pending.size();
+         const CellLocation location = *pending.begin();
+         pending.erase(pending.begin());
+         evaluateOne(context, location.first, location.second);
+         if (true == cancelled) // It may not have finished.
+          {
+            pending.insert(location);
+          }
+       }
+
+      if ((true == cancelled) && (false == abandon)) // Everything still pending is out of date, as though it were edited.
+       {
+         dirty.insert(pending.begin(), pending.end());
+       }
+      pending.clear();
+      incremental = false;
       ++context.generation;
+
+      if ((true == abandon) && (true == cancelled))
+       {
+         markAllDirty();
+       }
+      else if (true == abandon)
+       {
+         recalc(context);
+       }
+      else if (false == cancelled)
+       {
+         publish();
+       }
+    }
+
+   void SpreadSheet::publish()
+    {
+      std::lock_guard<std::mutex> guard (snapshotLock);
+      if (true == publishAll)
+       {
+         for (Column& column : sheet)
+          {
+            for (size_t row = column.next(0U); row < column.size(); row = column.next(row + 1U))
+             {
+               Cell* cell = column.get(row);
+               CellShown& shown = cell->shown();
+               shown.value = cell->previousValue;
+               shown.recursed = cell->recursed;
+             }
+          }
+       }
+      else
+       {
+         for (const CellLocation& location : unpublished)
+          {
+            Cell* cell = getCellAt(location.first, location.second);
+            if (nullptr != cell)
+             {
+               CellShown& shown = cell->shown();
+               shown.value = cell->previousValue;
+               shown.recursed = cell->recursed;
+             }
+          }
+       }
+      unpublished.clear();
+      publishAll = false;
+    }
+
+   void SpreadSheet::forgetReferences(const CellLocation& location)
+    {
+      std::map<CellLocation, std::vector<CellLocation> >::iterator iter = precedents.find(location);
+      if (precedents.end() != iter)
+       {
+         for (const CellLocation& to : iter->second)
+          {
+            std::map<CellLocation, std::set<CellLocation> >::iterator back = dependents.find(to);
+            if (dependents.end() != back)
+             {
+               back->second.erase(location);
+               if (true == back->second.empty())
+                {
+                  dependents.erase(back);
+                }
+             }
+          }
+         precedents.erase(iter);
+       }
+      std::map<CellLocation, std::vector<CellArea> >::iterator area = ranges.find(location);
+      if (ranges.end() != area)
+       {
+         for (const CellArea& item : area->second)
+          {
+            rangeIndex->remove(location, item);
+          }
+         ranges.erase(area);
+       }
+    }
+
+   void SpreadSheet::schedule(const CellLocation& location)
+    {
+      Cell* cell = getCellAt(location.first, location.second);
+      if (nullptr != cell)
+       {
+         cell->previousGeneration = 0U;
+         pending.insert(location);
+       }
+    }
+
+   void SpreadSheet::scheduleDependents(const CellLocation& location)
+    {
+      std::vector<CellLocation> from;
+      dependentsOf(location, from);
+      for (const CellLocation& item : from)
+       {
+         schedule(item);
+       }
+    }
+
+   void SpreadSheet::dependentsOf(const CellLocation& location, std::vector<CellLocation>& into) const
+    {
+      std::map<CellLocation, std::set<CellLocation> >::const_iterator iter = dependents.find(location);
+      if (dependents.end() != iter)
+       {
+         into.insert(into.end(), iter->second.begin(), iter->second.end());
+       }
+      std::set<CellLocation> over;
+      rangeIndex->find(location, over);
+      into.insert(into.end(), over.begin(), over.end());
+    }
+
+   void SpreadSheet::startEvaluation(CallingContext& context, const CellLocation& location)
+    {
+      if (true == context.inUserInput)
+       {
+         return;
+       }
+      if (nullptr != currentWorker) // This may be a cell that was deferred.
+       {
+         currentWorker->precedents.erase(location);
+         currentWorker->ranges.erase(location);
+         return;
+       }
+      forgetReferences(location);
+      orderDependent.erase(location);
+    }
+
+   void SpreadSheet::finishEvaluation(CallingContext& context, Cell* cell, const CellLocation& location, const std::shared_ptr<Types::ValueType>& oldValue, bool stateChanged)
+    {
+      if (true == context.inUserInput)
+       {
+         return;
+       }
+      ++progress;
+      if (true == incremental)
+       {
+         unpublished.insert(location);
+       }
+      if ((true == cell->recursed) || (true == stateChanged))
+       {
+         if (nullptr != currentWorker)
+          {
+            abandonParallel = true;
+            return;
+          }
+         orderDependent.insert(location);
+       }
+      if (true == incremental)
+       {
+         if (orderDependent.end() != orderDependent.find(location))
+          {
+            abandon = true;
+          }
+         else if (false == sameValue(oldValue, cell->previousValue))
+          {
+            scheduleDependents(location);
+          }
+       }
     }
 
  } // namespace Engine
@@ -30,6 +30,7 @@ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #include <fstream>
+#include <mutex>
 
 #include "Forwards/Engine/Cell.h"
 #include "Forwards/Engine/SpreadSheet.h"
@@ -68,29 +69,12 @@ static std::string harden(const std::string& in)
 
 void SaveFile(const std::string& fileName, Forwards::Engine::SpreadSheet* theSheet, const std::vector<int>& map, int def, const std::vector<std::pair<std::string, std::string> >& allLibs)
  {
+   std::lock_guard<std::mutex> snapshot (theSheet->snapshotLock); // A recalc may be running: don't change the sheet.
    std::ofstream file (fileName.c_str(), std::ios::out);
-   for (auto& column : theSheet->sheet)
+   size_t cols = theSheet->sheet.size();
+   while ((cols > 0U) && (0U == theSheet->sheet[cols - 1].count()))
     {
-      size_t s = column.size();
-      while ((s > 0U) && (nullptr == column[s - 1].get()))
-       {
-         --s;
-       }
-      if (s != column.size())
-       {
-         column.resize(s);
-       }
-    }
-    {
-      size_t s = theSheet->sheet.size();
-      while ((s > 0U) && (0U == theSheet->sheet[s - 1].size()))
-       {
-         --s;
-       }
-      if (s != theSheet->sheet.size())
-       {
-         theSheet->sheet.resize(s);
-       }
+      --cols;
     }
    if (false == allLibs.empty())
     {
@@ -120,9 +104,10 @@ void SaveFile(const std::string& fileName, Forwards::Engine::SpreadSheet* theShe
     {
       file << "<html><head><style>td { border: 1px solid black; }</style></head><body><table>" << std::endl;
     }
-   size_t col = 0U;
-   for (auto& column : theSheet->sheet)
+   for (size_t col = 0U; col < cols; ++col)
     {
+      const Forwards::Engine::Column& column = theSheet->sheet[col];
+      const size_t rows = column.previous(column.size()) + 1U; // NONE + 1 is zero.
       int width = getWidth(map, col, def);
       if (width == def)
        {
@@ -132,14 +117,14 @@ void SaveFile(const std::string& fileName, Forwards::Engine::SpreadSheet* theShe
        {
          file << "   <tr width=\"" << width << "\">";
        }
-      if (0U == column.size())
+      if (0U == rows)
        {
          file << "<td />"; // Insert one cell so that web browsers render the column.
        }
-      size_t row = 0U;
-      for (auto& cell : column)
+      for (size_t row = 0U; row < rows; ++row)
        {
-         if (nullptr == cell.get())
+         const Forwards::Engine::Cell* cell = column.get(row);
+         if (nullptr == cell)
           {
             file << "<td />";
           }
@@ -155,16 +140,16 @@ void SaveFile(const std::string& fileName, Forwards::Engine::SpreadSheet* theShe
              }
             else
              {
+                  // A LABEL's value is the constant that it evaluates to.
                std::string toPrint;
-               if (nullptr != cell->previousValue.get()) toPrint = cell->previousValue->toString(col, row);
+               std::shared_ptr<Forwards::Engine::Constant> text = std::dynamic_pointer_cast<Forwards::Engine::Constant>(cell->value);
+               if (nullptr != text.get()) toPrint = text->value->toString(col, row);
                else toPrint = cell->currentInput;
                file << "<td>&lt;" << harden(toPrint) << "</td>";
              }
           }
-         ++row;
        }
       file << "</tr>" << std::endl;
-      ++col;
     }
    file << "</table></body></html>" << std::endl;
  }